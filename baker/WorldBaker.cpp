@@ -0,0 +1,142 @@
+// Bakes the text level files of assets/map into the runtime map database, storing each distinct chunk payload once.
+// Usage: WorldBaker [level directory] [output database]
+#include "../vulkan-engine/include/GlobalConfiguration.h"
+#include "../vulkan-engine/include/rendering/ChunkEncoding.h"
+#include "../vulkan-engine/include/rendering/ChunkSummary.h"
+#include "../vulkan-engine/include/rendering/ContentHash.h"
+
+#include "BS_thread_pool.hpp"
+#include "SQLiteCpp/SQLiteCpp.h"
+#include "fmt/core.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BakedChunk {
+    uint32_t x;
+    uint32_t y;
+    // ChunkEncoding payload, empty when the level file is missing or malformed
+    std::vector<unsigned char> payload;
+    ChunkSummary summary;
+};
+
+static BakedChunk bakeChunk(const std::string &levelDirectory, uint32_t x, uint32_t y) {
+    BakedChunk chunk{x, y, {}, {}};
+
+    std::ifstream file(fmt::format("{}/{}_{}_level.txt", levelDirectory, x, y), std::ios::binary);
+    if (!file.is_open()) return chunk;
+
+    // Level files may be split into lines, the runs continue across them
+    std::string text{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    text.erase(std::remove_if(text.begin(), text.end(), [](char ch) { return ch == '\n' || ch == '\r'; }), text.end());
+
+    std::vector<unsigned char> blocks(CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH);
+    if (ChunkEncoding::decodeText(text.data(), text.size(), blocks.data(), blocks.size())) {
+        chunk.payload = ChunkEncoding::encode(blocks.data(), blocks.size());
+        chunk.summary = ChunkSummary::compute(blocks.data());
+    }
+    return chunk;
+}
+
+int main(int argc, char *argv[]) {
+    const std::string levelDirectory = argc > 1 ? argv[1] : "assets/map";
+    const std::string databasePath = argc > 2 ? argv[2] : "assets/map/mars.db3";
+    const auto start = std::chrono::steady_clock::now();
+
+    // Parse and encode on every core, the database is written from this thread only
+    BS::thread_pool pool{};
+    std::vector<std::future<BakedChunk>> chunks{};
+    for (uint32_t x = 0; x < MAP_WIDTH; x += CHUNK_SIZE) {
+        for (uint32_t y = 0; y < MAP_HEIGHT; y += CHUNK_SIZE) {
+            chunks.push_back(pool.submit(bakeChunk, levelDirectory, x, y));
+        }
+    }
+
+    SQLite::Database db(databasePath, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    // The file is rebuilt from scratch, a crash mid bake only needs another run
+    db.exec("PRAGMA journal_mode = OFF");
+    db.exec("PRAGMA synchronous = OFF");
+
+    SQLite::Transaction transaction(db);
+    db.exec("DROP VIEW IF EXISTS chunks");
+    db.exec("DROP TABLE IF EXISTS chunks");
+    db.exec("DROP TABLE IF EXISTS chunk_index");
+    db.exec("DROP TABLE IF EXISTS payloads");
+    // Identical chunks share one payload row. The chunks view keeps the (id, serialized, x, y) shape the game reads.
+    db.exec("CREATE TABLE payloads (id INTEGER PRIMARY KEY, data BLOB)");
+    // The summary columns are loaded for the whole map at startup, uniform_block is NULL for mixed chunks
+    db.exec("CREATE TABLE chunk_index (id TEXT PRIMARY KEY, x INTEGER, y INTEGER, payload_id INTEGER REFERENCES payloads (id), "
+            "min_height INTEGER, max_height INTEGER, solid_count INTEGER, uniform_block INTEGER)");
+    db.exec("CREATE VIEW chunks AS SELECT chunk_index.id, payloads.data AS serialized, chunk_index.x, chunk_index.y, chunk_index.payload_id "
+            "FROM chunk_index JOIN payloads ON payloads.id = chunk_index.payload_id");
+
+    SQLite::Statement insertPayload(db, "INSERT INTO payloads (data) VALUES (?)");
+    SQLite::Statement insertChunk(db, "INSERT INTO chunk_index (id, x, y, payload_id, min_height, max_height, solid_count, uniform_block) "
+                                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    // Payloads are looked up by their hash and compared byte for byte on a hit, the stored ones are moved out of the baked chunks
+    struct StoredPayload {
+        std::vector<unsigned char> data;
+        int64_t id;
+    };
+    std::vector<StoredPayload> storedPayloads{};
+    std::unordered_multimap<content_hash, size_t> payloadsByHash{};
+    uint32_t baked = 0;
+    uint32_t skipped = 0;
+    for (auto &future: chunks) {
+        BakedChunk chunk = future.get();
+        if (chunk.payload.empty()) {
+            fmt::print(stderr, "Chunk {}_{} has no valid level file, skipping it\n", chunk.x, chunk.y);
+            skipped++;
+            continue;
+        }
+
+        const content_hash hash = hashBytes(chunk.payload.data(), chunk.payload.size());
+        int64_t payloadId = -1;
+        for (auto [it, end] = payloadsByHash.equal_range(hash); it != end; ++it) {
+            if (storedPayloads[it->second].data == chunk.payload) {
+                payloadId = storedPayloads[it->second].id;
+                break;
+            }
+        }
+        if (payloadId < 0) {
+            insertPayload.bind(1, chunk.payload.data(), static_cast<int>(chunk.payload.size()));
+            insertPayload.exec();
+            insertPayload.reset();
+            payloadId = db.getLastInsertRowid();
+            payloadsByHash.emplace(hash, storedPayloads.size());
+            storedPayloads.push_back({std::move(chunk.payload), payloadId});
+        }
+
+        insertChunk.bind(1, fmt::format("{}_{}", chunk.x, chunk.y));
+        insertChunk.bind(2, chunk.x);
+        insertChunk.bind(3, chunk.y);
+        insertChunk.bind(4, payloadId);
+        insertChunk.bind(5, chunk.summary.minSolidHeight);
+        insertChunk.bind(6, chunk.summary.maxSolidHeight);
+        insertChunk.bind(7, chunk.summary.solidCount);
+        if (chunk.summary.isUniform()) {
+            insertChunk.bind(8, chunk.summary.uniformBlockId);
+        } else {
+            insertChunk.bind(8);
+        }
+        insertChunk.exec();
+        insertChunk.reset();
+        baked++;
+    }
+
+    // Building the index once after the inserts is cheaper than maintaining it row by row
+    db.exec("CREATE INDEX chunk_index_position ON chunk_index (x, y)");
+    transaction.commit();
+
+    const std::chrono::duration<float> duration = std::chrono::steady_clock::now() - start;
+    fmt::print("Baked {} chunks with {} unique payloads into {} in {} s, {} skipped\n",
+               baked, storedPayloads.size(), databasePath, duration.count(), skipped);
+    return skipped == 0 ? 0 : 1;
+}
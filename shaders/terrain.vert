@@ -0,0 +1,64 @@
+#version 450
+
+layout(location = 0) in uint position;
+layout(location = 1) in uint attributes;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+
+// Indexed by Block::FaceOrientation (LEFT, RIGHT, TOP, BOTTOM, FRONT, BACK), already in camera space
+const vec3 NORMALS[6] = vec3[] (
+vec3(0.0, 0.0, -1.0),
+vec3(0.0, 0.0, 1.0),
+vec3(0.0, -1.0, 0.0),
+vec3(0.0, 1.0, 0.0),
+vec3(-1.0, 0.0, 0.0),
+vec3(1.0, 0.0, 0.0)
+);
+
+const vec3 PALETTE[8] = vec3[] (
+vec3(0.757, 0.267, 0.055),
+vec3(0.612, 0.180, 0.208),
+vec3(0.871, 0.545, 0.294),
+vec3(0.482, 0.247, 0.141),
+vec3(0.659, 0.424, 0.290),
+vec3(0.322, 0.196, 0.149),
+vec3(0.910, 0.729, 0.537),
+vec3(0.500, 0.500, 0.500)
+);
+
+struct PointLight {
+    vec3 position;
+    vec4 color;
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    mat4 invViewMatrix;
+    vec4 ambientLightColor;
+    PointLight pointLights[10];
+    int numLights;
+} ubo;
+
+layout(push_constant) uniform Push {
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+} push;
+
+void main() {
+    vec3 localWorld = vec3(position & 0x3Fu, (position >> 6) & 0x3Fu, (position >> 12) & 0x1FFu);
+    // Same mapping as fromWorldToCamera
+    vec3 localCamera = vec3(localWorld.y, -localWorld.z, localWorld.x);
+
+    uint normalIndex = attributes & 0x7u;
+    uint colorIndex = (attributes >> 3) & 0xFFu;
+
+    vec4 positionWorld = push.modelMatrix * vec4(localCamera, 1.0);
+    gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
+
+    fragNormalWorld = normalize(mat3(push.normalMatrix) * NORMALS[normalIndex]);
+    fragPosWorld = positionWorld.xyz;
+    fragColor = PALETTE[colorIndex % 8u];
+}
@@ -0,0 +1,109 @@
+#version 450
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragPosWorld;
+layout(location = 2) out vec3 fragNormalWorld;
+
+// Everything below is in camera space and indexed by Block::FaceOrientation (LEFT, RIGHT, TOP, BOTTOM, FRONT, BACK)
+const vec3 NORMALS[6] = vec3[] (
+vec3(0.0, 0.0, -1.0),
+vec3(0.0, 0.0, 1.0),
+vec3(0.0, -1.0, 0.0),
+vec3(0.0, 1.0, 0.0),
+vec3(-1.0, 0.0, 0.0),
+vec3(1.0, 0.0, 0.0)
+);
+
+// First corner of the face relative to the voxel's minimum corner
+const vec3 FACE_ORIGINS[6] = vec3[] (
+vec3(0.0, 0.0, 0.0),
+vec3(0.0, 0.0, 1.0),
+vec3(0.0, 0.0, 0.0),
+vec3(0.0, 1.0, 0.0),
+vec3(0.0, 0.0, 0.0),
+vec3(1.0, 0.0, 0.0)
+);
+
+// Face edges, cross(FACE_U, FACE_V) is the outward normal so the quad winds counter clockwise
+const vec3 FACE_U[6] = vec3[] (
+vec3(0.0, 1.0, 0.0),
+vec3(1.0, 0.0, 0.0),
+vec3(1.0, 0.0, 0.0),
+vec3(0.0, 0.0, 1.0),
+vec3(0.0, 0.0, 1.0),
+vec3(0.0, 1.0, 0.0)
+);
+
+const vec3 FACE_V[6] = vec3[] (
+vec3(1.0, 0.0, 0.0),
+vec3(0.0, 1.0, 0.0),
+vec3(0.0, 0.0, 1.0),
+vec3(1.0, 0.0, 0.0),
+vec3(0.0, 1.0, 0.0),
+vec3(0.0, 0.0, 1.0)
+);
+
+// Quad corners of the two triangles, same pattern as the 0, 1, 2, 2, 3, 0 index list
+const vec2 CORNERS[6] = vec2[] (
+vec2(0.0, 0.0),
+vec2(1.0, 0.0),
+vec2(1.0, 1.0),
+vec2(1.0, 1.0),
+vec2(0.0, 1.0),
+vec2(0.0, 0.0)
+);
+
+const vec3 PALETTE[8] = vec3[] (
+vec3(0.757, 0.267, 0.055),
+vec3(0.612, 0.180, 0.208),
+vec3(0.871, 0.545, 0.294),
+vec3(0.482, 0.247, 0.141),
+vec3(0.659, 0.424, 0.290),
+vec3(0.322, 0.196, 0.149),
+vec3(0.910, 0.729, 0.537),
+vec3(0.500, 0.500, 0.500)
+);
+
+struct PointLight {
+    vec3 position;
+    vec4 color;
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo {
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+    mat4 invViewMatrix;
+    vec4 ambientLightColor;
+    PointLight pointLights[10];
+    int numLights;
+} ubo;
+
+// x: bits 0-4, y: bits 5-9, z: bits 10-17, direction: bits 18-20, block type: bits 21-28
+layout(set = 1, binding = 0) readonly buffer FaceBuffer {
+    uint faces[];
+} faceBuffer;
+
+layout(push_constant) uniform Push {
+    mat4 modelMatrix;
+    mat4 normalMatrix;
+} push;
+
+void main() {
+    uint face = faceBuffer.faces[gl_VertexIndex / 6];
+    vec2 corner = CORNERS[gl_VertexIndex % 6];
+
+    uvec3 voxel = uvec3(face & 0x1Fu, (face >> 5) & 0x1Fu, (face >> 10) & 0xFFu);
+    uint direction = (face >> 18) & 0x7u;
+    uint blockType = (face >> 21) & 0xFFu;
+
+    // Minimum corner of the voxel, same mapping as fromWorldToCamera
+    vec3 voxelCamera = vec3(float(voxel.y), -float(voxel.z) - 1.0, float(voxel.x));
+    vec3 position = voxelCamera + FACE_ORIGINS[direction] + corner.x * FACE_U[direction] + corner.y * FACE_V[direction];
+
+    vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
+    gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
+
+    fragNormalWorld = normalize(mat3(push.normalMatrix) * NORMALS[direction]);
+    fragPosWorld = positionWorld.xyz;
+    fragColor = PALETTE[blockType % 8u];
+}
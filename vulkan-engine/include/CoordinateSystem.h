@@ -6,6 +6,7 @@
 #include "GlobalConfiguration.h"
 
 #include "glm/glm.hpp"
+#include <cstdint>
 
 // World coordinate system - Left handed
 
@@ -25,6 +26,15 @@ static uint32_t fromWorldToChunkSerial(glm::uvec3 pos) {
     return pos.x + pos.y * CHUNK_SIZE + pos.z * CHUNK_SIZE * CHUNK_SIZE;
 }
 
+// Chunk positions packed into one integer key, x in the high and y in the low 32 bits
+static uint64_t packChunkPosition(glm::uvec2 pos) {
+    return (static_cast<uint64_t>(pos.x) << 32) | pos.y;
+}
+
+static glm::uvec2 unpackChunkPosition(uint64_t key) {
+    return {static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key)};
+}
+
 static glm::vec2 chunkToTheLeft(glm::vec2 pos) {
     return {pos.x + CHUNK_SIZE, pos.y};
 }
@@ -8,8 +8,6 @@
 #include "rendering/VulkanEngineRenderer.h"
 #include "rendering/GameObject.h"
 #include "rendering/Camera.h"
-#include "rendering/ChunkDeserializer.h"
-#include "rendering/ChunkManager.h"
 #include "rendering/gui/DebugGui.h"
 
 #include "systems/SimpleRenderSystem.h"
@@ -41,7 +39,6 @@ public:
 
 private:
     void loadGameObjects();
-    void loadChunkGameObjects(glm::vec3 playerPos);
 
     void run();
     void handleEvents();
@@ -56,7 +53,6 @@ private:
 
     std::unique_ptr<VulkanEngineDescriptorPool> globalPool{};
 
-    ChunkManager chunkManager{engineDevice};
     DebugGui debugGui{engineDevice, renderer, window.sdlWindow()};
 
     GameObject::Map gameObjects;
@@ -5,11 +5,37 @@
 
 #define CHUNK_SIZE 32
 #define CHUNK_DEPTH 256
+// Upper bound of exposed faces in one chunk, reached by a 3D checkerboard of solid blocks
+#define CHUNK_MAX_QUADS (CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH * 3)
 
 #define MAP_WIDTH 1920
 #define MAP_HEIGHT 1088
 
 #define CHUNK_LIFESPAN_SECONDS 30
 #define CHUNK_LOAD_DISTANCE 8
+#define CHUNK_MESHING_GREEDY true
+// Build chunk models from 8 byte VulkanModel::TerrainVertex quads drawn with shaders/terrain.vert instead of full vertices
+#define CHUNK_VERTICES_PACKED true
+// Build chunk models from one 32-bit record per exposed face pulled by shaders/terrain_faces.vert, takes precedence over
+// CHUNK_VERTICES_PACKED. Faces are never merged, CHUNK_MESHING_GREEDY does not apply.
+#define CHUNK_VERTEX_PULLING false
+// Mesh chunks with shaders/chunk_mesher.comp instead of the CPU workers
+#define CHUNK_MESHING_GPU false
+// Scratch face buffer capacity of GPU meshed chunks, chunks with more faces are meshed again into a buffer of their size
+#define CHUNK_GPU_INITIAL_FACES 65536
+// Read chunks from the memory mapped region archive instead of the SQLite map database
+#define CHUNK_STORE_REGION false
+#define CHUNK_REGION_PATH "assets/map/mars.region"
+// Read the region archive through io_uring batches instead of mapping it, set by the CHUNK_STORE_URING CMake option
+#ifndef CHUNK_STORE_URING
+#define CHUNK_STORE_URING false
+#endif
+// Decoded chunks kept for reuse by chunks with an identical payload, at most 32 KB each for air and solid only chunks
+#define CHUNK_DECODED_CACHE_SIZE 64
+// Pack the blocks of chunk sections in Z-order instead of x-major order, see ChunkBlockStorage::Layout
+#define CHUNK_BLOCK_LAYOUT_MORTON false
+
+// Log the chunk pipeline benchmarks of profiling/ChunkBenchmarks.h at startup
+#define CHUNK_BENCHMARKS false
 
 #define TIMER_ON false
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <precompiled_headers/PCH.h>
+#include <GlobalConfiguration.h>
+#include <platform/vulkan/VulkanDevice.h>
+#include <platform/vulkan/VulkanBuffer.h>
+#include <platform/vulkan/VulkanDescriptors.h>
+#include <platform/vulkan/VulkanComputePipeline.h>
+#include <platform/vulkan/VulkanModel.h>
+
+namespace VulkanEngine {
+
+    struct ComputeMesherPushConstants {
+        uint32_t faceCapacity{};
+    };
+
+    // Generates face models for the vertex pulling terrain renderer with shaders/chunk_mesher.comp, only core Vulkan 1.0 features are used.
+    // Chunks are meshed in batches of two submissions. The first meshes every chunk into a scratch buffer of initialFaceCapacity faces
+    // and is waited for to read the face counts back. The second fills models sized to the counts, copying the scratch faces or, for
+    // chunks that did not fit, meshing them again. Draws recorded later on the queue wait for it, its fence only releases the buffers.
+    class VulkanComputeMesher {
+    public:
+        // blockIds holds CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH ids in chunk serial order, apronRows the left, right, front and back
+        // neighbor rows with CHUNK_DEPTH entries each
+        struct ChunkInputs {
+            const unsigned char *blockIds;
+            const uint32_t *apronRows;
+        };
+
+        VulkanComputeMesher(VulkanDevice &device, VulkanDescriptorSetLayout &faceSetLayout, VulkanDescriptorPool &descriptorPool, uint32_t initialFaceCapacity);
+
+        ~VulkanComputeMesher();
+
+        VulkanComputeMesher(const VulkanComputeMesher &) = delete;
+
+        VulkanComputeMesher &operator=(const VulkanComputeMesher &) = delete;
+
+        // One model per chunk in the same order holding exactly its faces, nullptr for chunks without any
+        std::vector<std::unique_ptr<VulkanModel>> MeshChunks(const std::vector<ChunkInputs> &chunks);
+
+        std::unique_ptr<VulkanModel> MeshChunk(const unsigned char *blockIds, const uint32_t *apronRows);
+
+        // Copies the face counter of a model made by MeshChunk back to the host and waits for it
+        uint32_t ReadFaceCount(const VulkanModel &model);
+
+    private:
+        // Buffers of one chunk, kept until the batch meshing it has finished
+        struct ChunkJob {
+            std::unique_ptr<VulkanBuffer> blockBuffer;
+            std::unique_ptr<VulkanBuffer> apronBuffer;
+            std::unique_ptr<VulkanBuffer> scratchFaceBuffer;
+            std::unique_ptr<VulkanBuffer> scratchIndirectBuffer;
+            std::vector<VkDescriptorSet> descriptorSets;
+        };
+
+        // Submission whose chunk buffers are released once its fence is signaled
+        struct Batch {
+            VkCommandBuffer commandBuffer;
+            VkFence fence;
+            std::vector<ChunkJob> jobs;
+        };
+
+        struct Dispatch {
+            VkDescriptorSet descriptorSet;
+            VkBuffer indirectBuffer;
+            uint32_t faceCapacity;
+        };
+
+        void CreatePipelineLayout();
+
+        std::unique_ptr<VulkanBuffer> CreateInputBuffer(const void *data, uint32_t instanceCount);
+
+        VkDescriptorSet WriteMeshDescriptorSet(VulkanBuffer &blockBuffer, VulkanBuffer &apronBuffer, VulkanBuffer &faceBuffer, VulkanBuffer &indirectBuffer);
+
+        // Resets the indirect buffers and meshes every chunk, the dispatches are not synchronized with any later command
+        void RecordDispatches(VkCommandBuffer commandBuffer, const std::vector<Dispatch> &dispatches);
+
+        VkCommandBuffer BeginBatch();
+
+        VkFence SubmitBatch(VkCommandBuffer commandBuffer);
+
+        // Frees the batches whose fence is signaled, waits for all of them when wait is set
+        void ReleaseFinishedBatches(bool wait);
+
+        VulkanDevice &engineDevice_;
+        VulkanDescriptorSetLayout &faceSetLayout_;
+        VulkanDescriptorPool &descriptorPool_;
+        uint32_t initialFaceCapacity_;
+        std::vector<Batch> inFlightBatches_;
+
+        std::unique_ptr<VulkanDescriptorSetLayout> meshSetLayout_;
+        VkPipelineLayout pipelineLayout_{};
+        std::unique_ptr<VulkanComputePipeline> computePipeline_;
+    };
+}
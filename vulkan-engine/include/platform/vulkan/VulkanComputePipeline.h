@@ -0,0 +1,26 @@
+#pragma once
+
+#include <precompiled_headers/PCH.h>
+#include <platform/vulkan/VulkanDevice.h>
+
+namespace VulkanEngine {
+
+    class VulkanComputePipeline {
+    public:
+        VulkanComputePipeline(VulkanDevice &engineDevice, const std::string &compFilePath, VkPipelineLayout pipelineLayout);
+        ~VulkanComputePipeline();
+
+        VulkanComputePipeline(const VulkanComputePipeline &) = delete;
+        VulkanComputePipeline operator=(const VulkanComputePipeline &) = delete;
+
+        void Bind(VkCommandBuffer commandBuffer);
+
+    private:
+        void CreateComputePipeline(const std::string &compFilePath, VkPipelineLayout pipelineLayout);
+        void CreateShaderModule(const std::vector<char> &code, VkShaderModule *shaderModule);
+
+        VulkanDevice &engineDevice_;
+        VkPipeline computePipeline_;
+        VkShaderModule compShaderModule_;
+    };
+}
@@ -4,15 +4,18 @@
 #pragma once
 
 #include <precompiled_headers/PCH.h>
+#include <GlobalConfiguration.h>
 #include <renderer/GraphicsContext.h>
 #include <platform/vulkan/VulkanDevice.h>
 #include <platform/vulkan/VulkanRenderer.h>
 #include <platform/vulkan/VulkanDescriptors.h>
 #include <platform/vulkan/VulkanBuffer.h>
 #include <platform/vulkan/VulkanRenderSystem.h>
+#include <platform/vulkan/VulkanComputeMesher.h>
 #include <platform/vulkan/VulkanPointLightSystem.h>
 #include <platform/vulkan/VulkanFrameInfo.h>
 #include <platform/vulkan/VulkanGameObject.h>
+#include <rendering/ChunkManager.h>
 
 namespace VulkanEngine {
 
@@ -25,15 +28,28 @@ namespace VulkanEngine {
 
         VkCommandBuffer BeginFrame() override;
         void EndFrame(VkCommandBuffer commandBuffer) override;
+
     private:
+        // Moves the chunks around the player that finished meshing into gameObjects and drops the timed out ones
+        void LoadChunkGameObjects(glm::vec3 playerPosition);
+
         const Window& window_;
 
         std::unique_ptr<VulkanDevice> vulkanDevice_;
         std::unique_ptr<VulkanRenderer> vulkanRenderer_;
         std::unique_ptr<VulkanDescriptorPool> globalPool_;
         std::unique_ptr<VulkanDescriptorSetLayout> globalSetLayout_;
+        std::unique_ptr<VulkanDescriptorSetLayout> terrainFaceSetLayout_;
         std::unique_ptr<VulkanRenderSystem> renderSystem_;
+        std::unique_ptr<VulkanRenderSystem> terrainRenderSystem_;
+        std::unique_ptr<VulkanRenderSystem> terrainFaceRenderSystem_;
         std::unique_ptr<VulkanPointLightSystem> pointLightSystem_;
+        std::shared_ptr<VulkanBuffer> quadIndexBuffer_;
+        // nullptr unless CHUNK_MESHING_GPU is set and the mesher passed its check, chunks are then meshed on the CPU workers
+        std::unique_ptr<VulkanComputeMesher> computeMesher_;
+        std::unique_ptr<ChunkManager> chunkManager_;
+        // Replaced chunk models and the frames since, released once no frame in flight can use them
+        std::vector<std::pair<std::shared_ptr<VulkanModel>, uint32_t>> retiredChunkModels_;
         std::vector<std::unique_ptr<VulkanBuffer>> uboBuffers{VulkanSwapChain::MAX_FRAMES_IN_FLIGHT};
         std::vector<VkDescriptorSet> globalDescriptorSets{VulkanSwapChain::MAX_FRAMES_IN_FLIGHT};
 
@@ -14,6 +14,7 @@ namespace VulkanEngine {
         uint32_t presentFamily{};
         bool graphicsFamilyHasValue = false;
         bool presentFamilyHasValue = false;
+        bool graphicsFamilyHasCompute = false;
 
         [[nodiscard]] bool isComplete() const { return graphicsFamilyHasValue && presentFamilyHasValue; }
     };
@@ -58,6 +59,9 @@ namespace VulkanEngine {
 
         [[nodiscard]] QueueFamilyIndices FindPhysicalQueueFamilies() const { return FindQueueFamilies(physicalDevice_); }
 
+        // Compute work is recorded into single time commands on the graphics queue
+        [[nodiscard]] bool GraphicsQueueSupportsCompute() const { return FindPhysicalQueueFamilies().graphicsFamilyHasCompute; }
+
         [[nodiscard]] VkFormat FindSupportedFormat(
                 const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const;
 
@@ -43,6 +43,11 @@ namespace VulkanEngine {
             }
         }
 
+        // Used for chunks, the id follows from the packed chunk position
+        static VulkanGameObject CreateGameObject(uint64_t chunkKey) {
+            return VulkanGameObject{VulkanGameObject::GenerateGameObjectId(chunkKey)};
+        }
+
         static VulkanGameObject MakePointLight(float intensity = 2.f, float radius = 0.1f, glm::vec3 color = glm::vec3(1.f));
 
         static id_t GenerateGameObjectId(const std::string &chunk_id = "") {
@@ -50,13 +55,24 @@ namespace VulkanEngine {
             return hasher(chunk_id);
         }
 
+        static id_t GenerateGameObjectId(uint64_t chunkKey) {
+            // splitmix64 finalizer, every key bit affects the truncated id
+            chunkKey = (chunkKey ^ (chunkKey >> 30)) * 0xbf58476d1ce4e5b9ull;
+            chunkKey = (chunkKey ^ (chunkKey >> 27)) * 0x94d049bb133111ebull;
+            return static_cast<id_t>(chunkKey ^ (chunkKey >> 31));
+        }
+
         void Invalidate() {
             isInvalidated_ = true;
             isActive = false;
         }
 
-        bool GetIsInvalidated() {
-            if(isInvalidated_) invalidatedFrames_++;
+        // Called once per frame, counts the frames an invalidated object has been waiting for destruction
+        void TickInvalidation() {
+            if (isInvalidated_) invalidatedFrames_++;
+        }
+
+        [[nodiscard]] bool GetIsInvalidated() const {
             return isInvalidated_;
         }
 
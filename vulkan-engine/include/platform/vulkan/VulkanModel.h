@@ -6,6 +6,7 @@
 #include <precompiled_headers/PCH.h>
 #include <platform/vulkan/VulkanDevice.h>
 #include <platform/vulkan/VulkanBuffer.h>
+#include <platform/vulkan/VulkanDescriptors.h>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -18,6 +19,9 @@ namespace VulkanEngine {
 
     class VulkanModel {
     public:
+        enum VertexFormat {
+            VERTEX_FORMAT_DEFAULT, VERTEX_FORMAT_TERRAIN, VERTEX_FORMAT_TERRAIN_FACES
+        };
 
         struct Vertex {
             glm::vec3 position{};
@@ -35,15 +39,71 @@ namespace VulkanEngine {
             ~Vertex() = default;
         };
 
+        // 8 byte vertex for axis aligned voxel faces, position is local to the chunk in world coordinates
+        struct TerrainVertex {
+            // x: bits 0-5, y: bits 6-11, z: bits 12-20
+            uint32_t position{};
+            // normal index: bits 0-2, palette color index: bits 3-10
+            uint32_t attributes{};
+
+            static TerrainVertex Pack(glm::uvec3 localPosition, uint32_t normalIndex, uint32_t colorIndex);
+
+            static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+
+            static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+        };
+
+        // Quads [firstFace, firstFace + faceCount) of a mesh that all face the same direction
+        struct FaceRange {
+            uint32_t firstFace = 0;
+            uint32_t faceCount = 0;
+        };
+
         struct Builder {
             std::vector<Vertex> vertices{};
             std::vector<uint32_t> indices{};
+            // Optional, one range per Block::FaceOrientation when the quads are sorted by direction
+            std::vector<FaceRange> faceRanges{};
 
             void LoadModel(const std::string &filepath);
         };
 
+        struct TerrainBuilder {
+            std::vector<TerrainVertex> vertices{};
+            std::vector<uint32_t> indices{};
+            std::vector<FaceRange> faceRanges{};
+        };
+
+        // One record per visible voxel face, expanded into two triangles by shaders/terrain_faces.vert
+        struct FaceBuilder {
+            std::vector<uint32_t> faces{};
+            std::vector<FaceRange> faceRanges{};
+
+            // x: bits 0-4, y: bits 5-9, z: bits 10-17, direction: bits 18-20, block type: bits 21-28
+            static uint32_t PackFace(glm::uvec3 localPosition, uint32_t direction, uint32_t blockType);
+        };
+
+        // Indirect buffer of face models filled on the GPU, the draw command is followed by the number of faces the mesher found
+        struct IndirectFaceDraw {
+            VkDrawIndirectCommand command{};
+            uint32_t faceCounter{};
+        };
+
         VulkanModel(VulkanDevice &device, const VulkanModel::Builder &builder);
 
+        VulkanModel(VulkanDevice &device, const VulkanModel::TerrainBuilder &builder);
+
+        // Quad based models, 4 vertices per quad drawn through the shared quad index buffer, builder indices are ignored
+        VulkanModel(VulkanDevice &device, const VulkanModel::Builder &builder, std::shared_ptr<VulkanBuffer> quadIndexBuffer);
+
+        VulkanModel(VulkanDevice &device, const VulkanModel::TerrainBuilder &builder, std::shared_ptr<VulkanBuffer> quadIndexBuffer);
+
+        VulkanModel(VulkanDevice &device, const VulkanModel::FaceBuilder &builder, VulkanDescriptorSetLayout &faceSetLayout, VulkanDescriptorPool &descriptorPool);
+
+        // Face model with room for faceCapacity faces written or copied in by VulkanComputeMesher, drawn indirectly with the vertex count
+        // it writes
+        VulkanModel(VulkanDevice &device, uint32_t faceCapacity, VulkanDescriptorSetLayout &faceSetLayout, VulkanDescriptorPool &descriptorPool);
+
         ~VulkanModel();
 
         VulkanModel(const VulkanModel &) = delete;
@@ -52,24 +112,67 @@ namespace VulkanEngine {
 
         static std::unique_ptr<VulkanModel> CreateModelFromFile(VulkanDevice &device, const std::string &filepath);
 
+        // Immutable index buffer with the 0, 1, 2, 2, 3, 0 pattern repeated for maxQuads quads, each offset by 4 vertices
+        static std::shared_ptr<VulkanBuffer> CreateQuadIndexBuffer(VulkanDevice &device, uint32_t maxQuads);
+
         void Bind(VkCommandBuffer commandBuffer);
 
         void Draw(VkCommandBuffer commandBuffer) const;
 
+        // Draws only the face ranges whose bit (1 << Block::FaceOrientation) is set, adjacent ranges are merged into one draw
+        void DrawFaceRanges(VkCommandBuffer commandBuffer, uint32_t directionMask) const;
+
+        [[nodiscard]] bool HasFaceRanges() const { return !faceRanges_.empty(); };
+
+        // Model space bounds, only computed for models with face ranges
+        [[nodiscard]] glm::vec3 GetBoundsMin() const { return boundsMin_; };
+
+        [[nodiscard]] glm::vec3 GetBoundsMax() const { return boundsMax_; };
+
         [[nodiscard]] uint32_t GetVertexCount() const { return vertexCount_; };
 
+        [[nodiscard]] VertexFormat GetVertexFormat() const { return vertexFormat_; };
+
+        [[nodiscard]] VkDescriptorSet GetFaceDescriptorSet() const { return faceDescriptorSet_; };
+
+        [[nodiscard]] VulkanBuffer *GetFaceBuffer() const { return faceBuffer_.get(); };
+
+        [[nodiscard]] VulkanBuffer *GetIndirectBuffer() const { return indirectBuffer_.get(); };
+
     private:
-        void CreateVertexBuffer(const std::vector<Vertex> &vertices);
+        template<typename T>
+        void CreateVertexBuffer(const std::vector<T> &vertices);
 
         void CreateIndexBuffer(const std::vector<uint32_t> &indices);
 
+        void UseQuadIndexBuffer(std::shared_ptr<VulkanBuffer> quadIndexBuffer);
+
+        void CreateFaceBuffer(const std::vector<uint32_t> &faces);
+
+        void AllocateFaceDescriptorSet(VulkanDescriptorSetLayout &faceSetLayout);
+
+        void SetFaceRanges(const std::vector<FaceRange> &faceRanges, glm::vec3 boundsMin, glm::vec3 boundsMax);
+
+        void DrawFaces(VkCommandBuffer commandBuffer, uint32_t firstFace, uint32_t faceCount) const;
+
         VulkanDevice &engineDevice_;
+        VertexFormat vertexFormat_ = VERTEX_FORMAT_DEFAULT;
 
         std::unique_ptr<VulkanBuffer> vertexBuffer_;
         uint32_t vertexCount_{};
 
         bool hasIndexBuffer_ = false;
-        std::unique_ptr<VulkanBuffer> indexBuffer_;
+        std::shared_ptr<VulkanBuffer> indexBuffer_;
         uint32_t indexCount_{};
+
+        std::unique_ptr<VulkanBuffer> faceBuffer_;
+        uint32_t faceCount_{};
+        VkDescriptorSet faceDescriptorSet_ = VK_NULL_HANDLE;
+        VulkanDescriptorPool *descriptorPool_ = nullptr;
+        std::unique_ptr<VulkanBuffer> indirectBuffer_;
+
+        std::vector<FaceRange> faceRanges_;
+        glm::vec3 boundsMin_{0.f};
+        glm::vec3 boundsMax_{0.f};
     };
 }
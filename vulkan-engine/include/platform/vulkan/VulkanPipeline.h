@@ -41,9 +41,9 @@ namespace VulkanEngine {
         void Bind(VkCommandBuffer commandBuffer);
         static void DefaultPipelineConfig(PipelineConfigInfo &configInfo);
         static void EnableAlphaBlending(PipelineConfigInfo &configInfo);
+        static std::vector<char> ReadFile(const std::string &filePath);
 
     private:
-        static std::vector<char> ReadFile(const std::string &filePath);
         void CreateGraphicsPipeline(const std::string &vertFilePath, const std::string &fragFilePath, const PipelineConfigInfo &configInfo);
         void CreateShaderModule(const std::vector<char> &code, VkShaderModule *shaderModule);
 
@@ -18,7 +18,8 @@ namespace VulkanEngine {
 
     class VulkanRenderSystem {
     public:
-        VulkanRenderSystem(VulkanDevice &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkPolygonMode polygonMode, VkCullModeFlagBits cullMode);
+        VulkanRenderSystem(VulkanDevice &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkPolygonMode polygonMode, VkCullModeFlagBits cullMode,
+                           VulkanModel::VertexFormat vertexFormat = VulkanModel::VERTEX_FORMAT_DEFAULT, VkDescriptorSetLayout faceSetLayout = VK_NULL_HANDLE);
 
         ~VulkanRenderSystem();
 
@@ -29,13 +30,18 @@ namespace VulkanEngine {
         void RenderGameObjects(FrameInfo &frameInfo);
 
     private:
-        void CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout);
+        void CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout faceSetLayout);
 
         void CreatePipeline(VkRenderPass renderPass, VkPolygonMode polygonMode, VkCullModeFlagBits cullMode);
 
+        // Bit per Block::FaceOrientation of the face ranges that can face a camera at the given model space position
+        static uint32_t GetVisibleDirections(const VulkanModel &model, glm::vec3 cameraPosition);
+
         VulkanDevice &engineDevice_;
 
         bool isWireFrame_ = false;
+        bool cullsBackFaces_ = false;
+        VulkanModel::VertexFormat vertexFormat_;
 
         std::unique_ptr<VulkanPipeline> enginePipeline_;
         VkPipelineLayout pipelineLayout_{};
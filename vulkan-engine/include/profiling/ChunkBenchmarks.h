@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../rendering/ChunkDeserializer.h"
+#include "../GlobalConfiguration.h"
+
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine {
+    class VulkanComputeMesher;
+}
+
+// Offline measurements of the chunk pipeline, enabled with CHUNK_BENCHMARKS and reported through the core logger
+class ChunkBenchmarks {
+public:
+    // Runs every benchmark on the chunks around the map center
+    static void runAll();
+
+    // Decodes the same payloads through the two stage path (a RawChunkData vector filled per voxel, then copied into the blocks)
+    // the direct path that fills runs straight into the blocks and the packed path into ChunkBlockStorage. Database reads are
+    // done up front and not measured.
+    static void benchmarkDecoding(ChunkDeserializer &deserializer, const std::vector<glm::uvec2> &positions, uint32_t iterations);
+
+    // Packs the same payloads in the linear and the Morton ChunkBlockStorage layouts and measures packing, greedy and per face
+    // meshing and a six neighbor query over every block for each of them
+    static void benchmarkLayouts(ChunkDeserializer &deserializer, const std::vector<glm::uvec2> &positions, uint32_t iterations);
+
+    // Reads and decodes the same chunks from the SQLite map database and the region archive (and through io_uring when
+    // CHUNK_STORE_URING is built in). A missing archive at CHUNK_REGION_PATH is written from the database first.
+    static void benchmarkStores(ChunkDeserializer &deserializer, const std::vector<glm::uvec2> &positions, uint32_t iterations);
+
+    // Decodes and meshes synthetic chunks through the kernel tables of every chunk size ChunkMesher::findKernelTable provides, so the
+    // sizes can be compared without recompiling. Times are reported per chunk and per million blocks.
+    static void benchmarkKernelSizes(uint32_t iterations);
+
+    // Meshes the same synthetic chunk with shaders/chunk_mesher.comp and the CPU kernels and compares their face counts, returns
+    // false when they disagree. Runs on any Vulkan 1.0 device with compute on the graphics queue, lavapipe included.
+    static bool verifyComputeMesher(VulkanEngine::VulkanComputeMesher &mesher);
+
+private:
+    static std::vector<glm::uvec2> getPositionsAroundCenter(uint32_t radius);
+
+    // Deterministic terrain of size * size * depth block ids in chunk serial order, independent of the map database
+    static std::vector<Block::block_id> generateSyntheticChunk(uint32_t size, uint32_t depth);
+};
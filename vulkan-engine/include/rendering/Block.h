@@ -3,11 +3,12 @@
 //
 #pragma once
 
-#include "GameObject.h"
+#include <platform/vulkan/VulkanModel.h>
 #include "../CoordinateSystem.h"
 #include "../GlobalConfiguration.h"
 
 #include "glm/glm.hpp"
+#include <cassert>
 
 class Block {
 public:
@@ -29,12 +30,40 @@ public:
     [[nodiscard]] block_id getBlockId() const { return _id; };
     void setBlockId(block_id id) { _id = id; };
 
-    static VulkanEngineModel::Builder getFaceVertices(glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, glm::vec3 color);
-    static VulkanEngineModel::Builder
+    // Caller owned output storage with room for faceCapacity faces (4 vertices and 6 indices each)
+    struct FaceSpans {
+        VulkanEngine::VulkanModel::Vertex *vertices;
+        // nullptr for quad meshes drawn with the shared quad index buffer
+        uint32_t *indices;
+        uint32_t faceCapacity;
+        uint32_t faceCount = 0;
+    };
+
+    // Same for the packed terrain vertex format, these quads are always drawn with the shared quad index buffer
+    struct TerrainFaceSpans {
+        VulkanEngine::VulkanModel::TerrainVertex *vertices;
+        uint32_t faceCapacity;
+        uint32_t faceCount = 0;
+    };
+
+    // Writes faces straight into the spans without allocating, indices are relative to the start of the spans
+    static void emitFace(FaceSpans &out, glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, glm::vec3 color);
+    static void emitCubeFaces(FaceSpans &out, glm::vec3 world_pos, glm::vec3 size, glm::vec3 color, bool left, bool right, bool top, bool bottom, bool front,
+                              bool back);
+
+    // colorIndex selects the palette entry of shaders/terrain.vert
+    static void emitFace(TerrainFaceSpans &out, glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, uint32_t colorIndex);
+    static void emitCubeFaces(TerrainFaceSpans &out, glm::vec3 world_pos, glm::vec3 size, uint32_t colorIndex, bool left, bool right, bool top, bool bottom,
+                              bool front, bool back);
+
+    static VulkanEngine::VulkanModel::Builder getFaceVertices(glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, glm::vec3 color);
+    static VulkanEngine::VulkanModel::Builder
     getCubeFaces(glm::vec3 world_pos, glm::vec3 size, glm::vec3 color, bool left = true, bool right = true, bool top = true, bool bottom = true, bool front = true,
                  bool back = true);
 
 private:
+    // Corners of a face in camera space, already in the 0, 1, 2, 2, 3, 0 quad order
+    static void getFaceCorners(glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, glm::vec3 (&corners)[4], glm::vec2 (&uvs)[4], glm::vec3 &normal);
 
     block_id _id;
 };
\ No newline at end of file
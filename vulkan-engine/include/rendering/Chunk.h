@@ -3,9 +3,11 @@
 //
 #pragma once
 
+#include <platform/vulkan/VulkanGameObject.h>
+#include <platform/vulkan/VulkanModel.h>
 #include "Block.h"
-#include "GameObject.h"
-#include "VulkanEngineModel.h"
+#include "ChunkBlockStorage.h"
+#include "ChunkModelCache.h"
 #include "../CoordinateSystem.h"
 #include "../GlobalConfiguration.h"
 
@@ -13,6 +15,7 @@
 #include "glm/glm.hpp"
 #include <chrono>
 #include <future>
+#include <memory>
 #include <vector>
 #include <cassert>
 
@@ -24,12 +27,37 @@ typedef enum {
     CHUNK_STATE_INVALIDATED,
 } chunk_state;
 
+// Result of a meshing job, the builders are left empty when a model with the same content was already cached
+struct ChunkPrefab {
+    content_hash contentHash{};
+    content_key contentKey{};
+    VulkanEngine::VulkanModel::Builder builder{};
+    // Used instead of builder when CHUNK_VERTICES_PACKED is set
+    VulkanEngine::VulkanModel::TerrainBuilder terrainBuilder{};
+    // Used instead of both when CHUNK_VERTEX_PULLING is set
+    VulkanEngine::VulkanModel::FaceBuilder faceBuilder{};
+    // Inputs of VulkanComputeMesher::MeshChunk, gathered instead of any builder when chunks are meshed on the GPU
+    std::vector<unsigned char> blockIds{};
+    std::vector<uint32_t> apronRows{};
+    std::shared_ptr<VulkanEngine::VulkanModel> cachedModel{};
+
+    // Faces of the builder in use
+    [[nodiscard]] size_t getFaceCount() const {
+        if (CHUNK_VERTEX_PULLING) return faceBuilder.faces.size();
+        if (CHUNK_VERTICES_PACKED) return terrainBuilder.vertices.size() / 4;
+        return builder.vertices.size() / 4;
+    }
+};
+
 class Chunk {
 public:
-    using chunk_id = std::string;
-    using chunk_prefab = std::future<VulkanEngineModel::Builder>;
+    // Packed chunk position, see packChunkPosition
+    using chunk_id = uint64_t;
+    // Set on the key the border game object id is generated from
+    static constexpr chunk_id BORDER_KEY_FLAG = 1ull << 63;
+    using chunk_prefab = std::future<ChunkPrefab>;
 
-    explicit Chunk(chunk_id id = "error", glm::uvec2 pos = {0, 0}) : _id(std::move(id)), _position(pos), _state(CHUNK_STATE_REQUESTED) {
+    explicit Chunk(chunk_id id = 0, glm::uvec2 pos = {0, 0}) : _id(id), _position(pos), _state(CHUNK_STATE_REQUESTED) {
         activate();
     };
 
@@ -54,11 +82,18 @@ public:
         _activationTime = std::chrono::steady_clock::now();
     }
 
-    Block &getBlock(glm::uvec3 pos) { return _blocks[fromWorldToChunkSerial(pos)]; }
+    Block getBlock(glm::uvec3 pos) {
+        Block block{};
+        block.setBlockId(_blocks.getBlockId(fromWorldToChunkSerial(pos)));
+        return block;
+    }
+
+    // Blocks in fromWorldToChunkSerial order, for the chunk kernels
+    ChunkBlockStorage &getBlocks() { return _blocks; }
 
-    void setBlockId(glm::uvec3 pos, Block::block_id id) { getBlock(pos).setBlockId(id); }
+    void setBlockId(glm::uvec3 pos, Block::block_id id) { _blocks.setBlockId(fromWorldToChunkSerial(pos), id); }
 
-    static chunk_id getChunkId(glm::uvec2 position) { return fmt::format("{}_{}", position.x, position.y); };
+    static chunk_id getChunkId(glm::uvec2 position) { return packChunkPosition(position); };
 
     static glm::uvec2 getChunkFromPlayerPos(glm::vec3 player_pos) {
         if (!isInsideMapRange(player_pos)) { return {0, 0}; }
@@ -78,18 +113,22 @@ public:
         return _chunkPrefabFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
     }
 
-    GameObject createGameObject(VulkanEngineDevice &device) {
-        assert (_state == CHUNK_STATE_ACTIVE && "Chunk is not in active state, cannot create GameObject!");
+    // The model is built from the prefab with acquireModels and handed to createGameObject
+    ChunkPrefab takePrefab() {
         assert (checkIfPrefabReady() && "Chunk prefab future is not ready yet, check before calling this function!");
+        return _chunkPrefabFuture.get();
+    }
 
-        VulkanEngineModel::Builder result = _chunkPrefabFuture.get();
+    VulkanEngine::VulkanGameObject createGameObject(std::shared_ptr<VulkanEngine::VulkanModel> model) {
+        assert (_state == CHUNK_STATE_ACTIVE && "Chunk is not in active state, cannot create GameObject!");
+        assert (!_chunkPrefabFuture.valid() && "Chunk prefab has to be taken first!");
 
-        GameObject obj = GameObject::createGameObject(_id);
-        obj.model = std::make_unique<VulkanEngineModel>(device, result);
+        VulkanEngine::VulkanGameObject obj = VulkanEngine::VulkanGameObject::CreateGameObject(_id);
+        obj.model = std::move(model);
         obj.color = glm::vec3(1.0f, 0.0f, 0.0f);
         obj.transform.translation = {_position.y, 0, _position.x};
 
-        _gameObjectId = obj.getId();
+        _gameObjectId = obj.GetId();
         _state = CHUNK_STATE_VISIBLE;
 
         CORE_TRACE("Chunk {}_{} created\n", _position.x, _position.y);
@@ -99,13 +138,62 @@ public:
 
     chunk_state getChunkState() { return _state; }
 
-    id_t getGameObjectId() { return _gameObjectId; }
+    // Chunks without solid blocks have nothing to mesh, they become visible right away and never get a game object
+    void setEmpty() {
+        assert (_state == CHUNK_STATE_REQUESTED && "Only requested chunks can be marked empty!");
+        _empty = true;
+        _state = CHUNK_STATE_VISIBLE;
+    }
 
-    id_t getBorderGameObjectId() { return GameObject::generateGameObjectId(fmt::format("{}-border", _gameObjectId)); }
+    bool isEmpty() { return _empty; }
+
+    // Remeshing keeps the chunk visible with its current mesh until the new one is swapped in
+    void setChunkRemeshFuture(chunk_prefab prefab) {
+        assert (_state == CHUNK_STATE_VISIBLE && "Only visible chunks can be remeshed!");
+        _chunkRemeshFuture = std::move(prefab);
+    }
+
+    bool hasPendingRemesh() { return _chunkRemeshFuture.valid(); }
+
+    bool checkIfRemeshReady() {
+        assert (hasPendingRemesh() && "Chunk has no pending remesh!");
+        return _chunkRemeshFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // Clears the pending remesh, the model is built with acquireModels
+    ChunkPrefab takeRemeshedPrefab() {
+        assert (checkIfRemeshReady() && "Chunk remesh future is not ready yet, check before calling this function!");
+
+        CORE_TRACE("Chunk {}_{} remeshed\n", _position.x, _position.y);
+        return _chunkRemeshFuture.get();
+    }
+
+    // ApronNeighbors flags of the neighbors the current mesh was built with
+    uint8_t getApronNeighbors() { return _apronNeighbors; }
+
+    void setApronNeighbors(uint8_t neighbors) { _apronNeighbors = neighbors; }
+
+    glm::vec3 getColor() { return _color; }
+
+    // Hash of the decoded blocks, set once the chunk is populated
+    content_hash getBlocksHash() { return _blocksHash; }
+
+    void setBlocksHash(content_hash hash) { _blocksHash = hash; }
+
+    void setColor(glm::vec3 color) { _color = color; }
+
+    VulkanEngine::VulkanGameObject::id_t getGameObjectId() { return _gameObjectId; }
+
+    VulkanEngine::VulkanGameObject::id_t getBorderGameObjectId() { return VulkanEngine::VulkanGameObject::GenerateGameObjectId(_id | BORDER_KEY_FLAG); }
 
     void invalidate() { _state = CHUNK_STATE_INVALIDATED; }
 
-    static GameObject getChunkBorders(VulkanEngineDevice &_device, const Chunk &chunk);
+    static VulkanEngine::VulkanGameObject getChunkBorders(VulkanEngine::VulkanDevice &_device, const Chunk &chunk);
+
+    // Main thread only, one model per prefab in the same order. Fully enclosed chunks have no exposed faces, they get nullptr rather
+    // than an empty model. Prefabs meshed on the GPU share one compute mesher batch.
+    static std::vector<std::shared_ptr<VulkanEngine::VulkanModel>> acquireModels(VulkanEngine::VulkanDevice &device, ChunkModelCache &modelCache,
+                                                                                 std::vector<ChunkPrefab> &prefabs);
 
 private:
 
@@ -114,8 +202,13 @@ private:
     glm::uvec2 _position;
     std::chrono::time_point<std::chrono::steady_clock> _activationTime;
     chunk_prefab _chunkPrefabFuture;
-    id_t _gameObjectId;
-
-    Block _blocks[CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH];
+    chunk_prefab _chunkRemeshFuture;
+    uint8_t _apronNeighbors = 0;
+    bool _empty = false;
+    glm::vec3 _color{1.0f};
+    content_hash _blocksHash{};
+    VulkanEngine::VulkanGameObject::id_t _gameObjectId;
+
+    ChunkBlockStorage _blocks{};
 
 };
\ No newline at end of file
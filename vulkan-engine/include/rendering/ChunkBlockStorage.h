@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Block.h"
+#include "ContentHash.h"
+#include "ChunkSectionPool.h"
+#include "../GlobalConfiguration.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Morton position bits of one axis for every coordinate of the axis. Takes one bit of x, y and z in turn, skipping the axes
+// that ran out of bits, so a position spans exactly CHUNK_SIZE * CHUNK_SIZE * SectionHeight. Evaluated at compile time, the
+// tables are usable during static initialization.
+template<uint32_t Count, uint32_t SectionHeight>
+constexpr std::array<uint32_t, Count> makeMortonTable(uint32_t axis) {
+    static_assert((CHUNK_SIZE & (CHUNK_SIZE - 1)) == 0 && (SectionHeight & (SectionHeight - 1)) == 0,
+                  "Morton positions interleave whole bits, chunk size and section height must be powers of two");
+    const uint32_t axisBits[3] = {static_cast<uint32_t>(__builtin_ctz(CHUNK_SIZE)), static_cast<uint32_t>(__builtin_ctz(CHUNK_SIZE)),
+                                  static_cast<uint32_t>(__builtin_ctz(SectionHeight))};
+
+    std::array<uint32_t, Count> table{};
+    for (uint32_t value = 0; value < Count; value++) {
+        uint32_t outputBit = 0;
+        for (uint32_t bit = 0; bit < std::max(axisBits[0], axisBits[2]); bit++) {
+            for (uint32_t a = 0; a < 3; a++) {
+                if (bit >= axisBits[a]) continue;
+                if (a == axis && ((value >> bit) & 1u)) table[value] |= 1u << outputBit;
+                outputBit++;
+            }
+        }
+    }
+    return table;
+}
+
+// Block ids of one chunk in fromWorldToChunkSerial order, packed as indices into a palette of the ids the chunk uses.
+// Terrain chunks only hold air and solid blocks, one bit per block then doubles as the occupancy bitmap (32 KB instead of
+// 256 KB for a 32 x 32 x 256 chunk). The indices widen to 2, 4 and 8 bits as more block types appear.
+// The column is split into sections of SECTION_HEIGHT layers, a section of a single block type (bedrock, sky) is stored as
+// one palette index without any words. The words of packed sections come from ChunkSectionPool and the sections are stored
+// inline, moving a storage only moves the buffer handles.
+class ChunkBlockStorage {
+public:
+    using Word = ChunkSectionPool::Word;
+
+    static constexpr uint32_t VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH;
+    static constexpr uint32_t SECTION_HEIGHT = 16;
+    static constexpr uint32_t SECTION_COUNT = CHUNK_DEPTH / SECTION_HEIGHT;
+    static constexpr uint32_t SECTION_VOLUME = CHUNK_SIZE * CHUNK_SIZE * SECTION_HEIGHT;
+    static constexpr uint32_t WORD_BITS = 64;
+
+    static_assert(WORD_BITS % CHUNK_SIZE == 0, "A row of one bit indices must not straddle two words");
+    static_assert(CHUNK_DEPTH % SECTION_HEIGHT == 0, "Chunk depth must be a whole number of sections");
+
+    // Order of the blocks within the words of a packed section, the serial order of the interface is always x-major
+    enum Layout {
+        LINEAR,     // x fastest, then y, then z, a row of one bit indices is a slice of one word
+        MORTON      // Bits of x, y and z interleaved, neighbors along every axis stay within a few words
+    };
+
+    // Every block starts as air
+    ChunkBlockStorage() : ChunkBlockStorage(CHUNK_BLOCK_LAYOUT_MORTON ? MORTON : LINEAR) {};
+
+    explicit ChunkBlockStorage(Layout layout) : layout{layout} { fill(Block::BlockTypes::AIR); };
+    ~ChunkBlockStorage() = default;
+
+    // Copies acquire their own buffers
+    ChunkBlockStorage(const ChunkBlockStorage &other);
+    ChunkBlockStorage &operator=(const ChunkBlockStorage &other);
+    ChunkBlockStorage(ChunkBlockStorage &&) noexcept = default;
+    ChunkBlockStorage &operator=(ChunkBlockStorage &&) noexcept = default;
+
+    [[nodiscard]] Block::block_id getBlockId(uint32_t serial) const { return palette[getIndex(serial)]; }
+
+    // Adds the id to the palette and widens the indices when it does not fit, a uniform section gets its words on the first
+    // differing block
+    void setBlockId(uint32_t serial, Block::block_id id);
+
+    void fill(Block::block_id id);
+
+    // Ids hold VOLUME entries
+    void assign(const Block::block_id *ids);
+
+    // Packs the runs of a ChunkEncoding payload in either format, leaves the storage untouched and returns false when
+    // the payload is malformed
+    bool assignEncoded(const unsigned char *data, size_t size);
+
+    // Ids hold VOLUME entries
+    void copyTo(Block::block_id *ids) const;
+
+    // Bit x is set when block {x, y, z} is solid, one shift and mask for one bit indices and no lookup in uniform sections
+    [[nodiscard]] Word getSolidRow(uint32_t y, uint32_t z) const;
+
+    // Returns true and the block id of the whole layer when layer z lies in a uniform section
+    bool getUniformLayer(uint32_t z, Block::block_id &id) const;
+
+    [[nodiscard]] bool isSectionUniform(uint32_t section) const { return sections[section].uniformIndex != NOT_UNIFORM; };
+
+    // Equal storages hash equal, same content packed with a differently ordered palette may not
+    [[nodiscard]] content_hash hash() const;
+
+    // Appends the bytes hash() covers, equal storages append equal bytes
+    void appendContent(content_key &key) const;
+
+    [[nodiscard]] Layout getLayout() const { return layout; };
+    [[nodiscard]] uint32_t getBitsPerBlock() const { return bitsPerBlock; };
+    [[nodiscard]] const std::vector<Block::block_id> &getPalette() const { return palette; };
+    [[nodiscard]] size_t getMemoryUsage() const;
+
+private:
+    static constexpr uint16_t NO_INDEX = 0xFFFF;
+    static constexpr uint32_t NOT_UNIFORM = 0xFFFFFFFF;
+
+    struct Section {
+        // Palette index of every block of the section, NOT_UNIFORM when the indices are packed into words
+        uint32_t uniformIndex = 0;
+        ChunkSectionPool::Handle words{};
+    };
+
+    [[nodiscard]] uint32_t getIndex(uint32_t serial) const {
+        const Section &section = sections[serial / SECTION_VOLUME];
+        if (section.uniformIndex != NOT_UNIFORM) return section.uniformIndex;
+        return readIndex(section, getPosition(serial % SECTION_VOLUME));
+    }
+
+    // Position of a block within the words of its section from its serial within the section
+    [[nodiscard]] uint32_t getPosition(uint32_t local) const {
+        if (layout == LINEAR) return local;
+        return MORTON_X[local % CHUNK_SIZE] | MORTON_Y[(local / CHUNK_SIZE) % CHUNK_SIZE] | MORTON_Z[local / (CHUNK_SIZE * CHUNK_SIZE)];
+    }
+
+    [[nodiscard]] uint32_t readIndex(const Section &section, uint32_t position) const {
+        const uint32_t bit = position * bitsPerBlock;
+        return static_cast<uint32_t>(section.words[bit / WORD_BITS] >> (bit % WORD_BITS)) & ((1u << bitsPerBlock) - 1);
+    }
+
+    void writeIndex(Section &section, uint32_t position, uint32_t index) const {
+        const uint32_t bit = position * bitsPerBlock;
+        const Word mask = Word{(1u << bitsPerBlock) - 1} << (bit % WORD_BITS);
+        Word &word = section.words[bit / WORD_BITS];
+        word = (word & ~mask) | (Word{index} << (bit % WORD_BITS));
+    }
+
+    // Palette must already be set, every section is left uniform with index 0
+    void reset(uint32_t bits);
+    [[nodiscard]] ChunkSectionPool::Handle acquireWords(uint32_t bits) const;
+    void fillIndices(uint32_t first, uint32_t count, uint32_t index);
+    void fillSectionWords(Section &section, uint32_t first, uint32_t count, uint32_t index) const;
+    // Turns packed sections that ended up holding one index back into uniform ones
+    void compact();
+    uint32_t findOrAddIndex(Block::block_id id);
+    void updateSolidIndex();
+
+    // The index repeated across a whole word
+    [[nodiscard]] Word getPattern(uint32_t index) const;
+
+    static uint32_t getBitsFor(size_t paletteSize);
+
+    // Morton position bits contributed by each coordinate, a position is the OR of the three
+    static constexpr std::array<uint32_t, CHUNK_SIZE> MORTON_X = makeMortonTable<CHUNK_SIZE, SECTION_HEIGHT>(0);
+    static constexpr std::array<uint32_t, CHUNK_SIZE> MORTON_Y = makeMortonTable<CHUNK_SIZE, SECTION_HEIGHT>(1);
+    static constexpr std::array<uint32_t, SECTION_HEIGHT> MORTON_Z = makeMortonTable<SECTION_HEIGHT, SECTION_HEIGHT>(2);
+
+    Layout layout;
+
+    // Ids in the order they first appeared
+    std::vector<Block::block_id> palette{};
+    // 1, 2, 4 or 8, so indices never straddle two words
+    uint32_t bitsPerBlock = 1;
+    // Bottom section first
+    std::array<Section, SECTION_COUNT> sections{};
+    // Palette index of Block::SOLID or NO_INDEX
+    uint16_t solidIndex = NO_INDEX;
+};
@@ -1,8 +1,9 @@
 #pragma once
 
-#include "VulkanEngineDevice.h"
-#include "GameObject.h"
+#include <precompiled_headers/PCH.h>
 #include "Block.h"
+#include "ChunkEncoding.h"
+#include "ChunkStore.h"
 #include "../GlobalConfiguration.h"
 
 #include "SQLiteCpp/SQLiteCpp.h"
@@ -12,24 +13,67 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 
-class ChunkDeserializer {
+class ChunkDeserializer : public ChunkStore {
 public:
-    using RawChunkData = std::vector<unsigned char>;
+    static constexpr const char *DATABASE_PATH = "assets/map/mars.db3";
 
-    ChunkDeserializer() : db(SQLite::Database("assets/map/mars.db3", SQLite::OPEN_READONLY)) {};
-    ~ChunkDeserializer() = default;
+    // Opens the connection of the constructing thread right away so a missing database fails at startup
+    ChunkDeserializer() { acquireConnection(); };
+    ~ChunkDeserializer() override = default;
+
+    ChunkDeserializer(const ChunkDeserializer &) = delete;
+    ChunkDeserializer &operator=(const ChunkDeserializer &) = delete;
+
+    RawChunkData deserializeChunk(glm::uvec2 chunk_pos) override { return deserializeChunkFromDb(chunk_pos); }
 
     RawChunkData deserializeChunkFromFile(glm::uvec2 chunk_pos);
-    std::string readSerialChunkFromFile(glm::uvec2 chunk_pos);
 
+    // Accepts both the binary ChunkEncoding blobs and the legacy run length text rows.
+    // Every calling thread gets its own connection, so workers do not serialize on one connection mutex.
     RawChunkData deserializeChunkFromDb(glm::uvec2 chunk_pos);
 
+    // The row is copied as stored, binary or text
+    ChunkPayload readChunkPayload(glm::uvec2 chunk_pos) override;
+
+    // Reads every position with one range query over the integer x and y columns,
+    // databases without them are read one chunk at a time
+    std::vector<ChunkPayload> readChunkPayloads(const std::vector<glm::uvec2> &positions) override;
 
-    void createDatabaseFile();
+    // Baked databases carry the summaries in their chunk_index table
+    bool loadSummaries(ChunkSummaryIndex &index) override;
+
+    static RawChunkData decodeBinaryChunk(const unsigned char *data, size_t size);
+    static RawChunkData decodeTextChunk(const std::string &serialized);
 
 private:
+    // Read only connection used by a single thread, the chunk query is prepared once and reset after each use
+    struct WorkerConnection {
+        WorkerConnection();
+
+        // Binds the position to selectChunk, by the integer columns when the database has them
+        void bindChunkPosition(glm::uvec2 chunk_pos);
+
+        SQLite::Database db;
+        const bool hasCoordinateColumns;
+        SQLite::Statement selectChunk;
+        // Only prepared when the database has the coordinate columns
+        std::unique_ptr<SQLite::Statement> selectChunkRange;
+    };
+
+    static bool hasCoordinateColumns(SQLite::Database &db);
+
+    // Handles both the binary and the text column types
+    static RawChunkData decodeChunkColumn(const SQLite::Column &column, const std::string &id);
+    static ChunkPayload copyChunkColumn(const SQLite::Column &column);
+
+    WorkerConnection &acquireConnection();
 
-    SQLite::Database db;
+    std::mutex connectionsMutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<WorkerConnection>> connections{};
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "../GlobalConfiguration.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Versioned binary chunk payload: a 4 byte header ('C', 'H', 'K', version) followed by runs of
+// (varint run length, block id), the runs cover exactly CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH blocks
+class ChunkEncoding {
+public:
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 4;
+
+    static std::vector<unsigned char> encode(const unsigned char *blocks, size_t blockCount);
+
+    // Writes blockCount ids into blocks, returns false on an unknown header or a malformed payload
+    static bool decode(const unsigned char *data, size_t size, unsigned char *blocks, size_t blockCount);
+
+    // Legacy text rows hold runs of decimal lengths each followed by a one character block id, e.g. "1024s3072a"
+    static bool decodeText(const char *text, size_t size, unsigned char *blocks, size_t blockCount);
+
+    // Picks the decoder from the header, so legacy text rows and baked binary rows decode alike
+    static bool decodeAnyFormat(const unsigned char *data, size_t size, unsigned char *blocks, size_t blockCount);
+
+    static bool isEncoded(const unsigned char *data, size_t size);
+
+    // Calls sink(first, length, id) for every run in order, the runs of a valid payload cover [0, blockCount).
+    // Returns false on an unknown header or a malformed payload, the sink may already have seen some of its runs.
+    template<typename RunSink>
+    static bool forEachRun(const unsigned char *data, size_t size, size_t blockCount, RunSink &&sink) {
+        if (!isEncoded(data, size)) return false;
+
+        const unsigned char *it = data + HEADER_SIZE;
+        const unsigned char *end = data + size;
+        size_t written = 0;
+
+        while (it < end) {
+            uint64_t length = 0;
+            uint32_t shift = 0;
+            while (it < end && (*it & 0x80) && shift < 63) {
+                length |= static_cast<uint64_t>(*it & 0x7F) << shift;
+                shift += 7;
+                it++;
+            }
+            // The last varint byte and the block id must follow
+            if (end - it < 2 || (*it & 0x80)) return false;
+            length |= static_cast<uint64_t>(*it++) << shift;
+            const unsigned char id = *it++;
+
+            if (length > blockCount - written) return false;
+            sink(written, static_cast<size_t>(length), id);
+            written += length;
+        }
+
+        return written == blockCount;
+    }
+
+    // Legacy text counterpart of forEachRun
+    template<typename RunSink>
+    static bool forEachTextRun(const char *text, size_t size, size_t blockCount, RunSink &&sink) {
+        size_t written = 0;
+        uint64_t length = 0;
+        bool hasLength = false;
+
+        for (size_t i = 0; i < size; i++) {
+            const char ch = text[i];
+            if (ch >= '0' && ch <= '9') {
+                length = length * 10 + static_cast<uint64_t>(ch - '0');
+                if (length > blockCount) return false;
+                hasLength = true;
+                continue;
+            }
+
+            // Anything else closes the run with its block id
+            if (!hasLength || length > blockCount - written) return false;
+            sink(written, static_cast<size_t>(length), static_cast<unsigned char>(ch));
+            written += length;
+            length = 0;
+            hasLength = false;
+        }
+
+        return !hasLength && written == blockCount;
+    }
+
+    template<typename RunSink>
+    static bool forEachRunAnyFormat(const unsigned char *data, size_t size, size_t blockCount, RunSink &&sink) {
+        if (isEncoded(data, size)) {
+            return forEachRun(data, size, blockCount, sink);
+        }
+        return forEachTextRun(reinterpret_cast<const char *>(data), size, blockCount, sink);
+    }
+};
@@ -3,26 +3,69 @@
 //
 #pragma once
 
-#include "VulkanEngineDevice.h"
+#include <platform/vulkan/VulkanDevice.h>
 #include "ChunkDeserializer.h"
+#include "ChunkRegionStore.h"
+#include "ChunkUringStore.h"
 #include "Block.h"
 #include "Chunk.h"
+#include "ChunkMesher.h"
+#include "ChunkModelCache.h"
+#include "DecodedChunkCache.h"
 #include "../CoordinateSystem.h"
 #include "../GlobalConfiguration.h"
 #include "../profiling/Timer.h"
 
+#include "BS_thread_pool.hpp"
 #include "glm/glm.hpp"
 #include <cassert>
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <future>
 
 class ChunkManager {
 public:
     using ChunkMap = std::unordered_map<Chunk::chunk_id, Chunk>;
 
-    explicit ChunkManager(VulkanEngineDevice &device) : _device{device} {};
+    // Chunk models share quadIndexBuffer, it has to hold the quads of the largest chunk mesh. Face models of CHUNK_VERTEX_PULLING
+    // and the compute mesher bind their records through faceSetLayout. With a compute mesher the workers only load the chunks and
+    // the meshing runs on the GPU when their models are created, nullptr meshes on the workers.
+    ChunkManager(VulkanEngine::VulkanDevice &device, std::shared_ptr<VulkanEngine::VulkanBuffer> quadIndexBuffer,
+                 VulkanEngine::VulkanDescriptorSetLayout &faceSetLayout, VulkanEngine::VulkanDescriptorPool &descriptorPool,
+                 VulkanEngine::VulkanComputeMesher *computeMesher)
+            : _device{device}, modelCache{std::move(quadIndexBuffer), faceSetLayout, descriptorPool, computeMesher} {
+        if (CHUNK_STORE_REGION) {
+            // The archive is derived from the map database and rewritten whenever the database changed since. Without a database
+            // the archive is used as it is.
+            const uint64_t fingerprint = ChunkRegionStore::getSourceFingerprint(ChunkDeserializer::DATABASE_PATH);
+            if (fingerprint != 0 && !ChunkRegionStore::isUpToDate(CHUNK_REGION_PATH, fingerprint)) {
+                CORE_INFO("Writing the region archive {} from the map database\n", CHUNK_REGION_PATH);
+                ChunkDeserializer database{};
+                ChunkRegionStore::writeRegionFile(CHUNK_REGION_PATH, database, fingerprint);
+            }
+#if CHUNK_STORE_URING
+            chunkStore = std::make_unique<ChunkUringStore>(CHUNK_REGION_PATH);
+#else
+            chunkStore = std::make_unique<ChunkRegionStore>(CHUNK_REGION_PATH);
+#endif
+        } else {
+            chunkStore = std::make_unique<ChunkDeserializer>();
+        }
+
+        if (!chunkStore->loadSummaries(summaryIndex)) {
+            CORE_WARN("Chunk store has no summaries, every chunk is read and meshed\n");
+        }
+    };
     ~ChunkManager() = default;
 
+    // The map database, or the region archive under CHUNK_STORE_REGION, the chunk manager cannot be created without one
+    static bool isMapAvailable() {
+        return std::ifstream{ChunkDeserializer::DATABASE_PATH}.good() || (CHUNK_STORE_REGION && std::ifstream{CHUNK_REGION_PATH}.good());
+    }
+
     ChunkManager(const ChunkManager &) = delete;
     ChunkManager &operator=(const ChunkManager &) = delete;
 
@@ -31,17 +74,47 @@ public:
     void loadChunksAroundPlayerAsync(glm::vec3 player_pos, uint32_t distance);
 
     ChunkMap &getVisibleChunks();
+
+    // Only affects chunks requested after the change, already visible chunks keep their mesh
+    void setMeshingMode(ChunkMesher::MeshingMode mode) { meshingMode = mode; };
+    [[nodiscard]] ChunkMesher::MeshingMode getMeshingMode() const { return meshingMode; };
+
+    ChunkStore &getChunkStore() { return *chunkStore; };
+
+    // Loaded once at startup, for culling and level of detail decisions about chunks that are not loaded
+    const ChunkSummaryIndex &getSummaryIndex() const { return summaryIndex; };
+
+    // Chunks with identical content share one model
+    ChunkModelCache &getModelCache() { return modelCache; };
 private:
 
-    VulkanEngineModel::Builder generateChunkGameObjectPrefab(glm::uvec2 position);
+    // The chunk has to be populated first
+    ChunkPrefab generateChunkGameObjectPrefab(Chunk &chunk, const ChunkMesher::ChunkApron &apron, ChunkMesher::MeshingMode mode);
+
+    // Skips meshing when the model cache already holds a model for the same blocks, apron and mode
+    ChunkPrefab meshChunk(Chunk &chunk, const ChunkMesher::ChunkApron &apron, ChunkMesher::MeshingMode mode);
+    static content_hash hashMeshInputs(Chunk &chunk, const ChunkMesher::ChunkApron &apron, ChunkMesher::MeshingMode mode);
+    // The bytes behind hashMeshInputs, compared by the model cache so colliding hashes never share a model
+    static content_key getMeshInputs(Chunk &chunk, const ChunkMesher::ChunkApron &apron, ChunkMesher::MeshingMode mode);
+
+    // Returns the chunk at the given world position if it is loaded and meshed, nullptr otherwise
+    Chunk *findMeshedChunk(glm::ivec2 position);
+    ChunkMesher::ChunkApron buildChunkApron(glm::uvec2 position);
 
-    void populateChunk(Chunk &chunk, ChunkDeserializer::RawChunkData rawData);
+    // Also sets the blocks hash of the chunk
+    void populateChunk(Chunk &chunk, const ChunkStore::ChunkPayload &payload);
+    // Chunks the summary index reports as uniform are filled without reading the store
+    static void populateUniformChunk(Chunk &chunk, Block::block_id blockId);
 
-    VulkanEngineDevice &_device;
-    ChunkDeserializer terrainDeserializer{};
+    VulkanEngine::VulkanDevice &_device;
+    std::unique_ptr<ChunkStore> chunkStore;
+    ChunkSummaryIndex summaryIndex{};
 
     BS::thread_pool pool{};
     uint32_t max_running_jobs = 10;
+    ChunkMesher::MeshingMode meshingMode = CHUNK_MESHING_GREEDY ? ChunkMesher::GREEDY : ChunkMesher::PER_FACE;
 
+    ChunkModelCache modelCache;
+    DecodedChunkCache decodedCache{CHUNK_DECODED_CACHE_SIZE};
     ChunkMap _chunks = {};
 };
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <platform/vulkan/VulkanModel.h>
+#include "Block.h"
+#include "Chunk.h"
+#include "ChunkMeshingKernels.h"
+#include "../GlobalConfiguration.h"
+
+#include "glm/glm.hpp"
+#include <vector>
+
+// Meshes engine chunks with the kernels specialized for CHUNK_SIZE x CHUNK_SIZE x CHUNK_DEPTH
+class ChunkMesher {
+public:
+    using Kernels = ChunkMeshingKernels<CHUNK_SIZE, CHUNK_DEPTH>;
+    using ChunkApron = Kernels::Apron;
+    using OccupancyMasks = Kernels::OccupancyMasks;
+
+    enum MeshingMode {
+        PER_FACE,   // One quad per exposed voxel face
+        GREEDY      // Coplanar faces of the same block type merged into maximal rectangles per slice
+    };
+
+    // Entry points of one kernel specialization, so the chunk size can be chosen at startup
+    struct KernelTable {
+        uint32_t chunkSize;
+        uint32_t chunkDepth;
+        // Raw data and blocks hold chunkSize * chunkSize * chunkDepth entries
+        void (*decodeBlocks)(const unsigned char *rawData, Block *blocks);
+        // Meshes a chunk without neighbors, its border faces are all kept
+        VulkanEngine::VulkanModel::Builder (*generateIsolatedMesh)(const Block *blocks, glm::vec3 color, MeshingMode mode);
+    };
+
+    // Specializations are instantiated for chunk sizes 16, 32 and 64 with CHUNK_DEPTH, returns nullptr for other sizes
+    static const KernelTable *findKernelTable(uint32_t chunkSize);
+
+    // Quads are sorted by direction, faceRanges of the result holds one range per Block::FaceOrientation
+    static VulkanEngine::VulkanModel::Builder generateMesh(Chunk &chunk, const ChunkApron &apron, glm::vec3 color, MeshingMode mode);
+
+    // Same quads with packed vertices, colorIndex selects the palette entry of shaders/terrain.vert
+    static VulkanEngine::VulkanModel::TerrainBuilder generatePackedMesh(Chunk &chunk, const ChunkApron &apron, uint32_t colorIndex, MeshingMode mode);
+
+    // One packed record per exposed face for the vertex pulling terrain renderer, sorted by direction like generateMesh
+    static VulkanEngine::VulkanModel::FaceBuilder generateFaces(Chunk &chunk, const ChunkApron &apron);
+
+    // Left, right, front and back rows of the apron one after another, the layout shaders/chunk_mesher.comp reads
+    static std::vector<uint32_t> getApronRows(const ChunkApron &apron);
+
+    // Neighbors are read only, pass nullptr for the ones that are not loaded
+    static ChunkApron buildApron(Chunk *left, Chunk *right, Chunk *front, Chunk *back);
+};
@@ -0,0 +1,350 @@
+#pragma once
+
+#include <platform/vulkan/VulkanModel.h>
+#include "Block.h"
+#include "../CoordinateSystem.h"
+
+#include "glm/glm.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+enum ApronNeighbors {
+    APRON_LEFT = 1 << 0,
+    APRON_RIGHT = 1 << 1,
+    APRON_FRONT = 1 << 2,
+    APRON_BACK = 1 << 3
+};
+
+// Meshing and decoding kernels for a chunk of Size x Size x Depth blocks stored x fastest, then y, then z.
+// The dimensions are compile time constants so the row loops unroll and the serial index folds into shifts.
+// Blocks are read through a source with getBlockId(serial), getSolidRow(y, z) and getUniformLayer(z, id), see BlockArray and
+// ChunkBlockStorage.
+template<uint32_t Size, uint32_t Depth>
+class ChunkMeshingKernels {
+public:
+    static_assert(Size == 16 || Size == 32 || Size == 64, "Occupancy rows are stored in one machine word, chunk size must be 16, 32 or 64");
+
+    // One bit per block of a row along x
+    using Row = std::conditional_t<Size <= 32, uint32_t, uint64_t>;
+
+    static constexpr uint32_t SIZE = Size;
+    static constexpr uint32_t DEPTH = Depth;
+    static constexpr uint32_t VOLUME = Size * Size * Depth;
+    static constexpr Row ROW_MASK = Size == sizeof(Row) * 8 ? ~Row{0} : static_cast<Row>((Row{1} << Size) - 1);
+
+    static constexpr uint32_t serial(uint32_t x, uint32_t y, uint32_t z) { return x + y * Size + z * Size * Size; }
+
+    // One voxel border of the already loaded neighbor chunks, a missing neighbor leaves its side as air
+    struct Apron {
+        // Bit y of left[z] / right[z] is set when the neighbor block next to {0, y, z} / {Size - 1, y, z} is solid
+        std::vector<Row> left = std::vector<Row>(Depth, 0);
+        std::vector<Row> right = std::vector<Row>(Depth, 0);
+        // Bit x of front[z] / back[z] is set when the neighbor block next to {x, 0, z} / {x, Size - 1, z} is solid
+        std::vector<Row> front = std::vector<Row>(Depth, 0);
+        std::vector<Row> back = std::vector<Row>(Depth, 0);
+        // ApronNeighbors flags of the sides that were filled from a neighbor
+        uint8_t neighbors = 0;
+    };
+
+    // Block source over a plain array of Size * Size * Depth blocks
+    struct BlockArray {
+        const Block *blocks;
+
+        [[nodiscard]] Block::block_id getBlockId(uint32_t serial) const { return blocks[serial].getBlockId(); }
+
+        [[nodiscard]] Row getSolidRow(uint32_t y, uint32_t z) const {
+            const Block *blockRow = blocks + serial(0, y, z);
+            Row row = 0;
+            for (uint32_t x = 0; x < Size; x++) {
+                row |= Row{isSolid(blockRow[x])} << x;
+            }
+            return row;
+        }
+
+        // A plain array does not know which layers are uniform
+        bool getUniformLayer(uint32_t, Block::block_id &) const { return false; }
+    };
+
+    struct OccupancyMasks {
+        // Bit x of rows[z * Size + y] is set when block {x, y, z} is solid
+        std::vector<Row> rows;
+        Apron apron;
+        // Non zero when layer z holds a solid block, layers without any have no faces and are skipped
+        std::vector<uint8_t> solidLayers = std::vector<uint8_t>(Depth, 0);
+    };
+
+    // Raw chunk data is stored in the same order as the blocks, one block id per byte
+    static void decodeBlocks(const unsigned char *rawData, Block *blocks) {
+        for (uint32_t i = 0; i < VOLUME; i++) {
+            blocks[i].setBlockId(rawData[i]);
+        }
+    }
+
+    // Neighbors are read only, pass nullptr for the ones that are not loaded
+    template<typename Blocks>
+    static Apron buildApron(const Blocks *left, const Blocks *right, const Blocks *front, const Blocks *back) {
+        Apron apron{};
+
+        for (uint32_t z = 0; z < Depth; z++) {
+            // The front and back borders are whole rows, the left and right ones one bit of every row
+            if (front != nullptr) apron.front[z] = static_cast<Row>(front->getSolidRow(Size - 1, z));
+            if (back != nullptr) apron.back[z] = static_cast<Row>(back->getSolidRow(0, z));
+
+            for (uint32_t y = 0; y < Size && (left != nullptr || right != nullptr); y++) {
+                if (left != nullptr) apron.left[z] |= static_cast<Row>((left->getSolidRow(y, z) >> (Size - 1)) & 1u) << y;
+                if (right != nullptr) apron.right[z] |= static_cast<Row>(right->getSolidRow(y, z) & 1u) << y;
+            }
+        }
+
+        if (left != nullptr) apron.neighbors |= APRON_LEFT;
+        if (right != nullptr) apron.neighbors |= APRON_RIGHT;
+        if (front != nullptr) apron.neighbors |= APRON_FRONT;
+        if (back != nullptr) apron.neighbors |= APRON_BACK;
+
+        return apron;
+    }
+
+    template<typename Blocks>
+    static OccupancyMasks buildOccupancyMasks(const Blocks &blocks, const Apron &apron) {
+        OccupancyMasks masks{std::vector<Row>(Size * Depth, 0), apron};
+
+        for (uint32_t z = 0; z < Depth; z++) {
+            // Uniform layers are filled without reading their rows
+            Block::block_id uniformId;
+            if (blocks.getUniformLayer(z, uniformId)) {
+                if (uniformId != Block::BlockTypes::SOLID) continue;
+                std::fill_n(masks.rows.begin() + z * Size, Size, ROW_MASK);
+                masks.solidLayers[z] = 1;
+                continue;
+            }
+
+            Row any = 0;
+            for (uint32_t y = 0; y < Size; y++) {
+                const auto row = static_cast<Row>(blocks.getSolidRow(y, z));
+                masks.rows[z * Size + y] = row;
+                any |= row;
+            }
+            masks.solidLayers[z] = any != 0;
+        }
+
+        return masks;
+    }
+
+    // Returns the row {*, y, z} of blocks whose face in the given orientation is exposed
+    static Row getExposedFaces(const OccupancyMasks &masks, uint32_t y, uint32_t z, Block::FaceOrientation orientation) {
+        const std::vector<Row> &rows = masks.rows;
+        const Row row = rows[z * Size + y];
+
+        // Horizontal borders are covered by the apron, above and below the chunk is always air
+        switch (orientation) {
+            case Block::LEFT:
+                return row & ~((row << 1) | ((masks.apron.left[z] >> y) & 1u));
+            case Block::RIGHT:
+                return row & ~((row >> 1) | (((masks.apron.right[z] >> y) & 1u) << (Size - 1)));
+            case Block::FRONT:
+                return row & ~(y > 0 ? rows[z * Size + y - 1] : masks.apron.front[z]);
+            case Block::BACK:
+                return row & ~(y < Size - 1 ? rows[z * Size + y + 1] : masks.apron.back[z]);
+            case Block::BOTTOM:
+                return z > 0 ? row & ~rows[(z - 1) * Size + y] : row;
+            case Block::TOP:
+                return z < Depth - 1 ? row & ~rows[(z + 1) * Size + y] : row;
+        }
+        return 0;
+    }
+
+    // Exact quad count of the per-face mesh and an upper bound for the greedy one
+    static uint32_t countExposedFaces(const OccupancyMasks &masks) {
+        uint32_t count = 0;
+        for (auto orientation: ORIENTATIONS) {
+            for (uint32_t z = 0; z < Depth; z++) {
+                if (!masks.solidLayers[z]) continue;
+                for (uint32_t y = 0; y < Size; y++) {
+                    count += __builtin_popcountll(getExposedFaces(masks, y, z, orientation));
+                }
+            }
+        }
+        return count;
+    }
+
+    // One pass per direction keeps the quads of each direction contiguous. Spans is Block::FaceSpans with a glm::vec3 color or
+    // Block::TerrainFaceSpans with a palette color index.
+    template<typename Spans, typename Color>
+    static void generatePerFaceMesh(const OccupancyMasks &masks, Color color, Spans &out, std::vector<VulkanEngine::VulkanModel::FaceRange> &faceRanges) {
+        for (auto orientation: ORIENTATIONS) {
+            const uint32_t firstFace = out.faceCount;
+
+            for (uint32_t z = 0; z < Depth; z++) {
+                if (!masks.solidLayers[z]) continue;
+                for (uint32_t y = 0; y < Size; y++) {
+                    Row exposed = getExposedFaces(masks, y, z, orientation);
+                    while (exposed != 0) {
+                        const uint32_t x = __builtin_ctzll(exposed);
+                        exposed &= exposed - 1;
+
+                        Block::emitCubeFaces(out, {x, y, z}, {1.0f, 1.0f, 1.0f}, color, orientation == Block::LEFT, orientation == Block::RIGHT,
+                                             orientation == Block::TOP, orientation == Block::BOTTOM, orientation == Block::FRONT, orientation == Block::BACK);
+                    }
+                }
+            }
+
+            faceRanges[orientation] = {firstFace, out.faceCount - firstFace};
+        }
+    }
+
+    // Exposed faces are merged into maximal rectangles with bit operations. For every direction the exposed rows are gathered once
+    // into planes of words, a word holds one row of a slice along the quad width. Runs of set bits are the quad widths and a quad
+    // grows along the height while the next word covers its whole run.
+    template<typename Spans, typename Color>
+    static void generateGreedyMesh(const OccupancyMasks &masks, Color color, Spans &out, std::vector<VulkanEngine::VulkanModel::FaceRange> &faceRanges) {
+        // Word j of slice s is planes[s * planeHeight + j], the rows of left and right faces are transposed so their words run along y
+        std::vector<Row> planes(Size * Depth);
+
+        for (auto orientation: ORIENTATIONS) {
+            // d is the axis the faces are facing along, the quads grow along the width and height axes
+            int d, widthAxis, heightAxis;
+            if (orientation == Block::LEFT || orientation == Block::RIGHT) d = 0, widthAxis = 1, heightAxis = 2;
+            else if (orientation == Block::FRONT || orientation == Block::BACK) d = 1, widthAxis = 0, heightAxis = 2;
+            else d = 2, widthAxis = 0, heightAxis = 1;
+            const uint32_t sliceCount = d == 2 ? Depth : Size;
+            const uint32_t planeHeight = d == 2 ? Size : Depth;
+
+            std::fill(planes.begin(), planes.end(), 0);
+            for (uint32_t z = 0; z < Depth; z++) {
+                if (!masks.solidLayers[z]) continue;
+                for (uint32_t y = 0; y < Size; y++) {
+                    const Row exposed = getExposedFaces(masks, y, z, orientation);
+                    if (d == 0) {
+                        for (Row bits = exposed; bits != 0; bits &= bits - 1) {
+                            planes[__builtin_ctzll(bits) * Depth + z] |= Row{1} << y;
+                        }
+                    } else if (d == 1) {
+                        planes[y * Depth + z] = exposed;
+                    } else {
+                        planes[z * Size + y] = exposed;
+                    }
+                }
+            }
+
+            // Every direction is one pass, its quads end up contiguous
+            const uint32_t firstFace = out.faceCount;
+
+            for (uint32_t s = 0; s < sliceCount; s++) {
+                if (d == 2 && !masks.solidLayers[s]) continue;
+                Row *plane = planes.data() + s * planeHeight;
+
+                for (uint32_t j = 0; j < planeHeight; j++) {
+                    while (plane[j] != 0) {
+                        const uint32_t start = __builtin_ctzll(plane[j]);
+                        const Row free = ~(plane[j] >> start);
+                        const uint32_t width = free == 0 ? Size : __builtin_ctzll(free);
+                        const Row run = width == sizeof(Row) * 8 ? ~Row{0} : static_cast<Row>(((Row{1} << width) - 1) << start);
+
+                        uint32_t height = 1;
+                        while (j + height < planeHeight && (plane[j + height] & run) == run) {
+                            plane[j + height] &= ~run;
+                            height++;
+                        }
+                        plane[j] &= ~run;
+
+                        glm::vec3 origin{};
+                        origin[d] = (float) s;
+                        origin[widthAxis] = (float) start;
+                        origin[heightAxis] = (float) j;
+
+                        glm::vec3 size{};
+                        size[d] = 1.0f;
+                        size[widthAxis] = (float) width;
+                        size[heightAxis] = (float) height;
+
+                        Block::emitCubeFaces(out, origin, size, color, orientation == Block::LEFT, orientation == Block::RIGHT, orientation == Block::TOP,
+                                             orientation == Block::BOTTOM, orientation == Block::FRONT, orientation == Block::BACK);
+                    }
+                }
+            }
+
+            faceRanges[orientation] = {firstFace, out.faceCount - firstFace};
+        }
+    }
+
+    // Quads are sorted by direction, faceRanges of the result holds one range per Block::FaceOrientation. Only vertices are
+    // emitted, the quads are drawn through the shared quad index buffer.
+    template<typename Blocks>
+    static VulkanEngine::VulkanModel::Builder generateMesh(const Blocks &blocks, const Apron &apron, glm::vec3 color, bool greedy) {
+        VulkanEngine::VulkanModel::Builder terrainBuilder{};
+        fillQuadMesh<Block::FaceSpans>(blocks, apron, color, greedy, terrainBuilder);
+        return terrainBuilder;
+    }
+
+    // Same quads as generateMesh with 8 byte vertices for VulkanModel::VERTEX_FORMAT_TERRAIN
+    template<typename Blocks>
+    static VulkanEngine::VulkanModel::TerrainBuilder generatePackedMesh(const Blocks &blocks, const Apron &apron, uint32_t colorIndex, bool greedy) {
+        static_assert(Size < 64 && Depth < 512, "Packed terrain vertices hold x and y in 6 bits and z in 9 bits");
+
+        VulkanEngine::VulkanModel::TerrainBuilder terrainBuilder{};
+        fillQuadMesh<Block::TerrainFaceSpans>(blocks, apron, colorIndex, greedy, terrainBuilder);
+        return terrainBuilder;
+    }
+
+    // One packed record per exposed face for the vertex pulling terrain renderer, sorted by direction like generateMesh
+    template<typename Blocks>
+    static VulkanEngine::VulkanModel::FaceBuilder generateFaces(const Blocks &blocks, const Apron &apron) {
+        static_assert(Size <= 32 && Depth <= 256, "Face records pack x and y into 5 bits and z into 8 bits");
+
+        VulkanEngine::VulkanModel::FaceBuilder faceBuilder{};
+        const OccupancyMasks masks = buildOccupancyMasks(blocks, apron);
+        faceBuilder.faces.reserve(countExposedFaces(masks));
+        faceBuilder.faceRanges.resize(6);
+
+        // Faces are grouped by direction so the renderer can skip the ones facing away from the camera
+        for (auto orientation: ORIENTATIONS) {
+            const auto firstFace = static_cast<uint32_t>(faceBuilder.faces.size());
+
+            for (uint32_t z = 0; z < Depth; z++) {
+                if (!masks.solidLayers[z]) continue;
+                for (uint32_t y = 0; y < Size; y++) {
+                    Row exposed = getExposedFaces(masks, y, z, orientation);
+                    while (exposed != 0) {
+                        const uint32_t x = __builtin_ctzll(exposed);
+                        exposed &= exposed - 1;
+
+                        faceBuilder.faces.push_back(VulkanEngine::VulkanModel::FaceBuilder::PackFace({x, y, z}, orientation, blocks.getBlockId(serial(x, y, z))));
+                    }
+                }
+            }
+
+            faceBuilder.faceRanges[orientation] = {firstFace, static_cast<uint32_t>(faceBuilder.faces.size()) - firstFace};
+        }
+
+        return faceBuilder;
+    }
+
+private:
+    template<typename Spans, typename Blocks, typename Color, typename QuadBuilder>
+    static void fillQuadMesh(const Blocks &blocks, const Apron &apron, Color color, bool greedy, QuadBuilder &builder) {
+        const OccupancyMasks masks = buildOccupancyMasks(blocks, apron);
+
+        // Size the output once, the emitters then write into it without any further allocation
+        const uint32_t faceCapacity = countExposedFaces(masks);
+        builder.vertices.resize(faceCapacity * 4);
+        // FaceSpans::indices stays nullptr, there are no per model indices
+        Spans spans{builder.vertices.data()};
+        spans.faceCapacity = faceCapacity;
+        builder.faceRanges.resize(6);
+
+        if (greedy) {
+            generateGreedyMesh(masks, color, spans, builder.faceRanges);
+        } else {
+            generatePerFaceMesh(masks, color, spans, builder.faceRanges);
+        }
+
+        // Greedy meshing usually emits fewer quads than estimated, shrinking does not reallocate
+        builder.vertices.resize(spans.faceCount * 4);
+    }
+
+    static constexpr Block::FaceOrientation ORIENTATIONS[6] = {Block::LEFT, Block::RIGHT, Block::TOP, Block::BOTTOM, Block::FRONT, Block::BACK};
+
+    static bool isSolid(const Block &block) { return block.getBlockId() == Block::BlockTypes::SOLID; }
+};
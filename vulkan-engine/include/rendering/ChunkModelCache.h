@@ -0,0 +1,82 @@
+#pragma once
+
+#include <platform/vulkan/VulkanDevice.h>
+#include <platform/vulkan/VulkanBuffer.h>
+#include <platform/vulkan/VulkanDescriptors.h>
+#include <platform/vulkan/VulkanModel.h>
+#include "ContentHash.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine {
+    class VulkanComputeMesher;
+}
+
+// Chunk models keyed by the hash of everything their mesh is built from. Entries keep the hashed bytes to rule out collisions
+// and only hold weak references, a model lives as long as a game object uses it and is then dropped from the cache.
+class ChunkModelCache {
+public:
+    // Inputs of one chunk meshed on the GPU, see VulkanComputeMesher::ChunkInputs
+    struct GpuMeshRequest {
+        content_hash hash;
+        content_key key;
+        const unsigned char *blockIds;
+        const uint32_t *apronRows;
+    };
+
+    // Quad models are drawn through quadIndexBuffer, see VulkanModel::CreateQuadIndexBuffer. Face models allocate their set 1
+    // from descriptorPool. Without a compute mesher every model is built from a CPU mesh.
+    ChunkModelCache(std::shared_ptr<VulkanEngine::VulkanBuffer> quadIndexBuffer, VulkanEngine::VulkanDescriptorSetLayout &faceSetLayout,
+                    VulkanEngine::VulkanDescriptorPool &descriptorPool, VulkanEngine::VulkanComputeMesher *computeMesher)
+            : quadIndexBuffer{std::move(quadIndexBuffer)}, faceSetLayout{faceSetLayout}, descriptorPool{descriptorPool}, computeMesher{computeMesher} {};
+    ~ChunkModelCache() = default;
+
+    ChunkModelCache(const ChunkModelCache &) = delete;
+    ChunkModelCache &operator=(const ChunkModelCache &) = delete;
+
+    // Thread safe, returns nullptr when no live model has this content
+    std::shared_ptr<VulkanEngine::VulkanModel> find(content_hash hash, const content_key &key);
+
+    // Main thread only, uploads the builder unless a model with the same content appeared in the meantime
+    std::shared_ptr<VulkanEngine::VulkanModel> getOrCreate(VulkanEngine::VulkanDevice &device, content_hash hash, content_key key,
+                                                           const VulkanEngine::VulkanModel::Builder &builder);
+
+    std::shared_ptr<VulkanEngine::VulkanModel> getOrCreate(VulkanEngine::VulkanDevice &device, content_hash hash, content_key key,
+                                                           const VulkanEngine::VulkanModel::TerrainBuilder &builder);
+
+    // The face builder has to hold at least one face
+    std::shared_ptr<VulkanEngine::VulkanModel> getOrCreate(VulkanEngine::VulkanDevice &device, content_hash hash, content_key key,
+                                                           const VulkanEngine::VulkanModel::FaceBuilder &builder);
+
+    // Main thread only, meshes every request without a cached model in one compute mesher batch, see VulkanComputeMesher::MeshChunks.
+    // One model per request in the same order, nullptr for chunks without faces.
+    std::vector<std::shared_ptr<VulkanEngine::VulkanModel>> getOrCreate(std::vector<GpuMeshRequest> requests);
+
+    [[nodiscard]] bool meshesOnGpu() const { return computeMesher != nullptr; };
+
+    // Number of distinct models currently referenced by game objects
+    size_t getLiveModelCount();
+
+private:
+    struct Entry {
+        content_key key;
+        std::weak_ptr<VulkanEngine::VulkanModel> model;
+    };
+
+    // Stores a freshly uploaded model, dropping expired entries every now and then
+    std::shared_ptr<VulkanEngine::VulkanModel> insert(content_hash hash, content_key key, std::shared_ptr<VulkanEngine::VulkanModel> model);
+
+    std::shared_ptr<VulkanEngine::VulkanBuffer> quadIndexBuffer;
+    VulkanEngine::VulkanDescriptorSetLayout &faceSetLayout;
+    VulkanEngine::VulkanDescriptorPool &descriptorPool;
+    VulkanEngine::VulkanComputeMesher *computeMesher;
+    std::mutex mutex;
+    std::unordered_map<content_hash, Entry> models{};
+
+    static constexpr size_t MIN_PRUNE_THRESHOLD = 256;
+    size_t pruneThreshold = MIN_PRUNE_THRESHOLD;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ChunkStore.h"
+#include "ChunkEncoding.h"
+#include "../GlobalConfiguration.h"
+
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <string>
+
+// Read only chunk archive mapped into memory. The file starts with a RegionHeader, followed by a fixed index of
+// gridWidth * gridHeight RegionEntry records (x major) and the ChunkEncoding payloads they point to.
+// Chunks with identical payloads share one copy, their entries hold the same offset. Every entry carries the summary of its chunk.
+class ChunkRegionStore : public ChunkStore {
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    struct RegionHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t chunkSize;
+        uint32_t chunkDepth;
+        uint32_t gridWidth;
+        uint32_t gridHeight;
+        // getSourceFingerprint of the map database the archive was written from
+        uint64_t sourceFingerprint;
+    };
+
+    struct RegionEntry {
+        uint64_t offset;
+        // 0 for chunks missing from the archive
+        uint32_t length;
+        // ChunkSummary of the chunk, only valid when length is not 0
+        uint32_t solidCount;
+        uint16_t minSolidHeight;
+        uint16_t maxSolidHeight;
+        uint16_t uniformBlockId;
+        uint16_t reserved;
+    };
+
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+    // Checks the magic, the version and that the archive was written for CHUNK_SIZE and CHUNK_DEPTH
+    static bool isCompatible(const RegionHeader &regionHeader);
+    // Offset of the first payload byte
+    static size_t getIndexEnd(const RegionHeader &regionHeader);
+    // Index of the chunk in the entry table, NO_ENTRY for positions outside the archive
+    static uint32_t getEntryIndex(const RegionHeader &regionHeader, glm::uvec2 chunk_pos);
+    // Fills the index with the summaries of every chunk in the entry table, returns the number of summaries
+    static uint32_t loadEntrySummaries(const RegionHeader &regionHeader, const RegionEntry *regionEntries, ChunkSummaryIndex &index);
+
+    // Changes whenever the file at the path is rewritten, 0 when it does not exist
+    static uint64_t getSourceFingerprint(const std::string &sourcePath);
+    // True when the archive at the path is compatible and was written from the source with this fingerprint
+    static bool isUpToDate(const std::string &path, uint64_t sourceFingerprint);
+
+    explicit ChunkRegionStore(const std::string &path);
+    ~ChunkRegionStore() override;
+
+    ChunkRegionStore(const ChunkRegionStore &) = delete;
+    ChunkRegionStore &operator=(const ChunkRegionStore &) = delete;
+
+    RawChunkData deserializeChunk(glm::uvec2 chunk_pos) override;
+    // Copies the encoded payload out of the mapping like every ChunkStore does, see ChunkStore::ChunkPayload. Prefer
+    // getChunkPayload when the data is consumed right away.
+    ChunkPayload readChunkPayload(glm::uvec2 chunk_pos) override;
+
+    // Encoded payload inside the mapping, no copy is made. Returns false when the chunk is not in the archive.
+    bool getChunkPayload(glm::uvec2 chunk_pos, const unsigned char *&data, size_t &size) const;
+
+    bool loadSummaries(ChunkSummaryIndex &index) override;
+
+    // Writes an archive of every chunk on the map read from the given store. The archive is written next to the path and
+    // renamed over it once complete, a crash never leaves a truncated archive behind.
+    static void writeRegionFile(const std::string &path, ChunkStore &source, uint64_t sourceFingerprint);
+
+private:
+    const unsigned char *mapping = nullptr;
+    size_t mappingSize = 0;
+
+    const RegionHeader *header = nullptr;
+    const RegionEntry *entries = nullptr;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Fixed size word buffers for packed chunk sections. Released buffers are recycled instead of returned to the allocator, so
+// streaming chunks in and out does not churn the heap. Buffers are carved out of slabs of SLAB_BUFFERS buffers of the same
+// size, slabs are only freed with the pool.
+class ChunkSectionPool {
+public:
+    using Word = uint64_t;
+
+    static constexpr uint32_t SLAB_BUFFERS = 64;
+
+    // Move only owner of one buffer, gives it back to the pool when destroyed. Moving swaps the pointer.
+    class Handle {
+    public:
+        Handle() = default;
+        ~Handle() { reset(); };
+
+        Handle(const Handle &) = delete;
+        Handle &operator=(const Handle &) = delete;
+
+        Handle(Handle &&other) noexcept: words{std::exchange(other.words, nullptr)}, wordCount{std::exchange(other.wordCount, 0)} {};
+
+        Handle &operator=(Handle &&other) noexcept {
+            if (this != &other) {
+                reset();
+                words = std::exchange(other.words, nullptr);
+                wordCount = std::exchange(other.wordCount, 0);
+            }
+            return *this;
+        }
+
+        Word *data() { return words; };
+        [[nodiscard]] const Word *data() const { return words; };
+        [[nodiscard]] uint32_t size() const { return wordCount; };
+
+        Word &operator[](size_t i) { return words[i]; };
+        const Word &operator[](size_t i) const { return words[i]; };
+
+        explicit operator bool() const { return words != nullptr; };
+
+        void reset();
+
+    private:
+        friend class ChunkSectionPool;
+
+        Handle(Word *words, uint32_t wordCount) : words{words}, wordCount{wordCount} {};
+
+        Word *words = nullptr;
+        uint32_t wordCount = 0;
+    };
+
+    // Shared by every chunk of the process, the storages hold their handles past any single owner
+    static ChunkSectionPool &getInstance();
+
+    ChunkSectionPool() = default;
+    ~ChunkSectionPool() = default;
+
+    ChunkSectionPool(const ChunkSectionPool &) = delete;
+    ChunkSectionPool &operator=(const ChunkSectionPool &) = delete;
+
+    // Thread safe, the contents of the buffer are unspecified
+    Handle acquire(uint32_t wordCount);
+
+    size_t getSlabBytes() const;
+    size_t getFreeBufferCount() const;
+
+private:
+    void release(Word *words, uint32_t wordCount);
+
+    mutable std::mutex mutex;
+    // Released buffers by their size in words
+    std::unordered_map<uint32_t, std::vector<Word *>> freeBuffers{};
+    std::vector<std::pair<std::unique_ptr<Word[]>, size_t>> slabs{};
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ChunkSummary.h"
+
+#include "glm/glm.hpp"
+#include <vector>
+
+// Source of chunk blocks, implemented by the SQLite map database and the memory mapped region archive
+class ChunkStore {
+public:
+    using RawChunkData = std::vector<unsigned char>;
+    // Chunk as stored, either a ChunkEncoding payload or a legacy run length text row.
+    // ChunkEncoding::decodeAnyFormat expands it straight into block storage. Payloads are owned copies on purpose, SQLite rows
+    // and io_uring reads have no lasting address to point at and DecodedChunkCache keeps the bytes to compare on a hit.
+    // Encoded chunks are small, the copy is cheap next to the decode.
+    using ChunkPayload = std::vector<unsigned char>;
+
+    virtual ~ChunkStore() = default;
+
+    // Blocks of the chunk at the given world position in chunk serial order, empty when the chunk is missing or corrupt.
+    // Called from the chunk loading workers concurrently.
+    virtual RawChunkData deserializeChunk(glm::uvec2 chunk_pos) = 0;
+
+    // Undecoded chunk, empty when it is missing. Called from the chunk loading workers concurrently.
+    virtual ChunkPayload readChunkPayload(glm::uvec2 chunk_pos) = 0;
+
+    // One payload per position in the same order. Stores that can read many chunks in one request override this.
+    virtual std::vector<ChunkPayload> readChunkPayloads(const std::vector<glm::uvec2> &positions) {
+        std::vector<ChunkPayload> payloads{};
+        payloads.reserve(positions.size());
+        for (const auto &position: positions) {
+            payloads.push_back(readChunkPayload(position));
+        }
+        return payloads;
+    }
+
+    // Fills the index with every summary the store holds, returns false for stores without summaries
+    virtual bool loadSummaries(ChunkSummaryIndex &index) { return false; }
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../GlobalConfiguration.h"
+
+#include "glm/glm.hpp"
+#include <cstdint>
+#include <vector>
+
+// Per chunk statistics written by WorldBaker, loaded for the whole map at startup so chunks can be skipped, culled or
+// given a level of detail without reading their blocks
+struct ChunkSummary {
+    // Matches Block::BlockTypes::SOLID, kept here so the baker does not depend on the engine
+    static constexpr unsigned char SOLID_BLOCK_ID = 's';
+    static constexpr uint16_t NOT_UNIFORM = 0xFFFF;
+
+    // Lowest and highest z holding a solid block, both 0 for chunks without solid blocks
+    uint16_t minSolidHeight = 0;
+    uint16_t maxSolidHeight = 0;
+    uint32_t solidCount = 0;
+    // Block id filling the whole chunk, NOT_UNIFORM when it holds more than one
+    uint16_t uniformBlockId = NOT_UNIFORM;
+
+    [[nodiscard]] bool isEmpty() const { return solidCount == 0; }
+    [[nodiscard]] bool isUniform() const { return uniformBlockId != NOT_UNIFORM; }
+
+    // Blocks are CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH ids in chunk serial order
+    static ChunkSummary compute(const unsigned char *blocks) {
+        const uint32_t layer = CHUNK_SIZE * CHUNK_SIZE;
+
+        ChunkSummary summary{};
+        summary.uniformBlockId = blocks[0];
+        bool hasSolid = false;
+        for (uint32_t z = 0; z < CHUNK_DEPTH; z++) {
+            uint32_t layerSolids = 0;
+            for (uint32_t i = z * layer; i < (z + 1) * layer; i++) {
+                layerSolids += blocks[i] == SOLID_BLOCK_ID;
+                if (blocks[i] != summary.uniformBlockId) summary.uniformBlockId = NOT_UNIFORM;
+            }
+            if (layerSolids == 0) continue;
+
+            if (!hasSolid) summary.minSolidHeight = static_cast<uint16_t>(z);
+            summary.maxSolidHeight = static_cast<uint16_t>(z);
+            summary.solidCount += layerSolids;
+            hasSolid = true;
+        }
+        return summary;
+    }
+};
+
+// Summaries of every chunk on the map in a grid of MAP_WIDTH / CHUNK_SIZE by MAP_HEIGHT / CHUNK_SIZE cells
+class ChunkSummaryIndex {
+public:
+    static constexpr uint32_t GRID_WIDTH = MAP_WIDTH / CHUNK_SIZE;
+    static constexpr uint32_t GRID_HEIGHT = MAP_HEIGHT / CHUNK_SIZE;
+
+    ChunkSummaryIndex() : summaries(GRID_WIDTH * GRID_HEIGHT), known(GRID_WIDTH * GRID_HEIGHT, false) {};
+
+    void set(glm::uvec2 chunk_pos, const ChunkSummary &summary) {
+        const uint32_t cell = getCell(chunk_pos);
+        if (cell == NO_CELL) return;
+        summaries[cell] = summary;
+        known[cell] = true;
+    }
+
+    // nullptr when the store had no summary for the chunk
+    [[nodiscard]] const ChunkSummary *find(glm::uvec2 chunk_pos) const {
+        const uint32_t cell = getCell(chunk_pos);
+        if (cell == NO_CELL || !known[cell]) return nullptr;
+        return &summaries[cell];
+    }
+
+private:
+    static constexpr uint32_t NO_CELL = UINT32_MAX;
+
+    static uint32_t getCell(glm::uvec2 chunk_pos) {
+        const uint32_t gridX = chunk_pos.x / CHUNK_SIZE;
+        const uint32_t gridY = chunk_pos.y / CHUNK_SIZE;
+        if (gridX >= GRID_WIDTH || gridY >= GRID_HEIGHT) return NO_CELL;
+        return gridX * GRID_HEIGHT + gridY;
+    }
+
+    std::vector<ChunkSummary> summaries;
+    std::vector<bool> known;
+};
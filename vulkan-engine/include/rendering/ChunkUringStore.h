@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../GlobalConfiguration.h"
+
+#if CHUNK_STORE_URING
+
+#include "ChunkStore.h"
+#include "ChunkRegionStore.h"
+
+#include "glm/glm.hpp"
+#include <liburing.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Reads region archives with io_uring instead of mapping them. A batch submits the reads of every requested chunk at once,
+// so one loading job keeps up to QUEUE_DEPTH reads in flight instead of blocking on each page fault in turn.
+class ChunkUringStore : public ChunkStore {
+public:
+    static constexpr unsigned QUEUE_DEPTH = 64;
+
+    explicit ChunkUringStore(const std::string &path);
+    ~ChunkUringStore() override;
+
+    ChunkUringStore(const ChunkUringStore &) = delete;
+    ChunkUringStore &operator=(const ChunkUringStore &) = delete;
+
+    RawChunkData deserializeChunk(glm::uvec2 chunk_pos) override;
+    // Single reads skip the ring and use pread
+    ChunkPayload readChunkPayload(glm::uvec2 chunk_pos) override;
+    std::vector<ChunkPayload> readChunkPayloads(const std::vector<glm::uvec2> &positions) override;
+
+    bool loadSummaries(ChunkSummaryIndex &index) override;
+
+private:
+    // nullptr for chunks missing from the archive
+    const ChunkRegionStore::RegionEntry *findEntry(glm::uvec2 chunk_pos) const;
+
+    int fd = -1;
+    ChunkRegionStore::RegionHeader header{};
+    // Copied out of the file once, only the payloads are read per chunk
+    std::vector<ChunkRegionStore::RegionEntry> entries{};
+
+    // Submission and completion queues are not thread safe, batches take turns
+    std::mutex ringMutex;
+    io_uring ring{};
+};
+
+#endif
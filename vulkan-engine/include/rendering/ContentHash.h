@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Hashes of chunk content, shared by the model cache, the decoded chunk cache and the block storage
+using content_hash = uint64_t;
+// The bytes a content hash was computed from
+using content_key = std::vector<unsigned char>;
+
+inline content_hash hashBytes(const void *data, size_t size, content_hash seed = 0xcbf29ce484222325ull) {
+    // FNV-1a over 64-bit words with a fold so the high word bits reach the low hash bits, the tail is hashed byte by byte
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    content_hash hash = seed;
+
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(uint64_t));
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+
+    return hash;
+}
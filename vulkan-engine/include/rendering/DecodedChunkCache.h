@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ChunkStore.h"
+#include "ChunkBlockStorage.h"
+#include "ContentHash.h"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Decoded blocks keyed by the hash of the payload they were decoded from, so chunks with identical payloads are decoded
+// and hashed once. Holds the most recently used capacity entries.
+class DecodedChunkCache {
+public:
+    struct DecodedChunk {
+        // Kept to rule out hash collisions, payloads are a few kilobytes at most
+        ChunkStore::ChunkPayload payload;
+        ChunkBlockStorage blocks;
+        content_hash blocksHash;
+    };
+
+    explicit DecodedChunkCache(size_t capacity) : capacity{capacity} {};
+    ~DecodedChunkCache() = default;
+
+    DecodedChunkCache(const DecodedChunkCache &) = delete;
+    DecodedChunkCache &operator=(const DecodedChunkCache &) = delete;
+
+    // Thread safe, returns nullptr when the payload has not been decoded recently
+    std::shared_ptr<const DecodedChunk> find(const ChunkStore::ChunkPayload &payload);
+
+    // Thread safe, evicts the least recently used entry when full
+    void insert(std::shared_ptr<const DecodedChunk> decoded);
+
+    size_t getHitCount() const { return hits; };
+    size_t getMissCount() const { return misses; };
+
+private:
+    using Entry = std::pair<content_hash, std::shared_ptr<const DecodedChunk>>;
+
+    const size_t capacity;
+
+    std::mutex mutex;
+    // Front is the most recently used entry
+    std::list<Entry> entries{};
+    std::unordered_map<content_hash, std::list<Entry>::iterator> index{};
+    std::atomic<size_t> hits{0};
+    std::atomic<size_t> misses{0};
+};
@@ -61,7 +61,6 @@ void Game::run() {
         frameStartTime = newFrameStartTime;
 
         handleEvents();
-        loadChunkGameObjects(fromCameraToWorld(viewerObject.transform.translation));
 
         // Move camera
         cameraController.moveInPlaneXZ(frameTime, viewerObject);
@@ -125,51 +124,6 @@ void Game::loadGameObjects() {
     }
 }
 
-void Game::loadChunkGameObjects(glm::vec3 playerPos) {
-    if (chunkLoadingDisabled) return;
-    chunkManager.loadChunksAroundPlayerAsync(playerPos, CHUNK_LOAD_DISTANCE);
-
-    // Move newly loaded chunks into gameObjects
-    for (auto &chunk: chunkManager.getVisibleChunks()) {
-        chunk_state state = chunk.second.getChunkState();
-        if (state == CHUNK_STATE_ACTIVE) {
-
-            // If chunk is active and prefab is ready, copy chunk into game objects
-            if (chunk.second.checkIfPrefabReady()) {
-                GameObject chunkGameObj = chunk.second.createGameObject(engineDevice);
-                if (gameObjects.emplace(chunkGameObj.getId(), std::move(chunkGameObj)).second) {
-                    glm::uvec2 pos = chunk.second.getChunkPosition();
-                    GameObject border = Chunk::getChunkBorders(engineDevice, chunk.second);
-                    unsigned int borderId = border.getId();
-                    if (gameObjects.emplace(borderId, std::move(border)).second) {
-                        chunkBorderIds.push_back(borderId);
-                    }
-                }
-            }
-        } else if (state == CHUNK_STATE_VISIBLE) {
-
-            // If the chunk is timed out -> remove it from game objects and set its state to deleted
-            if (chunk.second.isTimedOut()) {
-                // Invalidate the game object
-                {
-                    auto obj = gameObjects.find(chunk.second.getGameObjectId());
-                    if (obj != gameObjects.end()) { obj->second.invalidate(); }
-                }
-
-                // Also invalidate the border
-                {
-                    id_t chunkBorderId = chunk.second.getBorderGameObjectId();
-                    auto obj = gameObjects.find(chunkBorderId);
-                    if (obj != gameObjects.end()) { obj->second.invalidate(); }
-                    chunkBorderIds.erase(std::remove(chunkBorderIds.begin(), chunkBorderIds.end(), chunkBorderId), chunkBorderIds.end());
-                }
-
-                chunk.second.invalidate();
-            }
-        }
-    }
-}
-
 void Game::handleEvents() {
     SDL_Event event;
     while (SDL_PollEvent(&event) != 0) {
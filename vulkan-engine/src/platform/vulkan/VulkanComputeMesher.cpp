@@ -0,0 +1,301 @@
+#include <platform/vulkan/VulkanComputeMesher.h>
+
+#include <cstddef>
+#include <cstring>
+
+namespace VulkanEngine {
+
+    static_assert(CHUNK_SIZE == 32 && CHUNK_DEPTH == 256, "shaders/chunk_mesher.comp is written for 32 x 32 x 256 chunks");
+
+    VulkanComputeMesher::VulkanComputeMesher(VulkanDevice &device, VulkanDescriptorSetLayout &faceSetLayout, VulkanDescriptorPool &descriptorPool,
+                                             uint32_t initialFaceCapacity)
+            : engineDevice_{device}, faceSetLayout_{faceSetLayout}, descriptorPool_{descriptorPool}, initialFaceCapacity_{initialFaceCapacity} {
+        CORE_ASSERT(engineDevice_.GraphicsQueueSupportsCompute(), "Compute meshing requires a graphics queue with compute support")
+
+        meshSetLayout_ = VulkanDescriptorSetLayout::Builder(engineDevice_)
+                .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                .AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                .AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                .AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                .Build();
+
+        CreatePipelineLayout();
+        computePipeline_ = std::make_unique<VulkanComputePipeline>(engineDevice_, "shaders/chunk_mesher.comp.spv", pipelineLayout_);
+    }
+
+    VulkanComputeMesher::~VulkanComputeMesher() {
+        ReleaseFinishedBatches(true);
+        vkDestroyPipelineLayout(engineDevice_.GetDevice(), pipelineLayout_, nullptr);
+    }
+
+    void VulkanComputeMesher::CreatePipelineLayout() {
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(ComputeMesherPushConstants);
+
+        VkDescriptorSetLayout descriptorSetLayout = meshSetLayout_->GetDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        VkResult result = vkCreatePipelineLayout(engineDevice_.GetDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout_);
+        CORE_ASSERT(result == VK_SUCCESS, "Failed to create compute mesher pipeline layout!")
+    }
+
+    std::unique_ptr<VulkanBuffer> VulkanComputeMesher::CreateInputBuffer(const void *data, uint32_t instanceCount) {
+        // Inputs are read once per chunk, host visible memory saves the staging copy
+        auto buffer = std::make_unique<VulkanBuffer>(
+                engineDevice_,
+                sizeof(uint32_t),
+                instanceCount,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        buffer->Map();
+        buffer->WriteToBuffer((void *) data);
+        buffer->Unmap();
+        return buffer;
+    }
+
+    VkDescriptorSet VulkanComputeMesher::WriteMeshDescriptorSet(VulkanBuffer &blockBuffer, VulkanBuffer &apronBuffer, VulkanBuffer &faceBuffer,
+                                                                VulkanBuffer &indirectBuffer) {
+        auto blockInfo = blockBuffer.DescriptorInfo();
+        auto apronInfo = apronBuffer.DescriptorInfo();
+        auto faceInfo = faceBuffer.DescriptorInfo();
+        auto indirectInfo = indirectBuffer.DescriptorInfo();
+
+        VkDescriptorSet meshDescriptorSet;
+        bool allocated = VulkanDescriptorWriter(*meshSetLayout_, descriptorPool_)
+                .WriteBuffer(0, &blockInfo)
+                .WriteBuffer(1, &apronInfo)
+                .WriteBuffer(2, &faceInfo)
+                .WriteBuffer(3, &indirectInfo)
+                .Build(meshDescriptorSet);
+        CORE_ASSERT(allocated, "Failed to allocate compute mesher descriptor set!")
+        return meshDescriptorSet;
+    }
+
+    void VulkanComputeMesher::RecordDispatches(VkCommandBuffer commandBuffer, const std::vector<Dispatch> &dispatches) {
+        // One instance of faceCounter * 6 vertices, the counters start at zero
+        VulkanModel::IndirectFaceDraw indirectDraw{};
+        indirectDraw.command.instanceCount = 1;
+        for (const auto &dispatch: dispatches) {
+            vkCmdUpdateBuffer(commandBuffer, dispatch.indirectBuffer, 0, sizeof(indirectDraw), &indirectDraw);
+        }
+
+        VkMemoryBarrier resetBarrier{};
+        resetBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+
+        computePipeline_->Bind(commandBuffer);
+        for (const auto &dispatch: dispatches) {
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout_, 0, 1, &dispatch.descriptorSet, 0, nullptr);
+
+            ComputeMesherPushConstants push{dispatch.faceCapacity};
+            vkCmdPushConstants(commandBuffer, pipelineLayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ComputeMesherPushConstants), &push);
+
+            // One workgroup per z slice, one invocation per row of the slice
+            vkCmdDispatch(commandBuffer, CHUNK_DEPTH, 1, 1);
+        }
+    }
+
+    VkCommandBuffer VulkanComputeMesher::BeginBatch() {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = engineDevice_.GetCommandPool();
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        vkAllocateCommandBuffers(engineDevice_.GetDevice(), &allocInfo, &commandBuffer);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        return commandBuffer;
+    }
+
+    VkFence VulkanComputeMesher::SubmitBatch(VkCommandBuffer commandBuffer) {
+        vkEndCommandBuffer(commandBuffer);
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkFence fence;
+        VkResult result = vkCreateFence(engineDevice_.GetDevice(), &fenceInfo, nullptr, &fence);
+        CORE_ASSERT(result == VK_SUCCESS, "Failed to create compute mesher fence!")
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+
+        result = vkQueueSubmit(engineDevice_.GraphicsQueue(), 1, &submitInfo, fence);
+        CORE_ASSERT(result == VK_SUCCESS, "Failed to submit compute mesher batch!")
+        return fence;
+    }
+
+    void VulkanComputeMesher::ReleaseFinishedBatches(bool wait) {
+        VkDevice device = engineDevice_.GetDevice();
+        for (auto it = inFlightBatches_.begin(); it != inFlightBatches_.end();) {
+            if (wait) {
+                vkWaitForFences(device, 1, &it->fence, VK_TRUE, UINT64_MAX);
+            } else if (vkGetFenceStatus(device, it->fence) != VK_SUCCESS) {
+                ++it;
+                continue;
+            }
+
+            for (auto &job: it->jobs) {
+                descriptorPool_.FreeDescriptors(job.descriptorSets);
+            }
+            vkDestroyFence(device, it->fence, nullptr);
+            vkFreeCommandBuffers(device, engineDevice_.GetCommandPool(), 1, &it->commandBuffer);
+            it = inFlightBatches_.erase(it);
+        }
+    }
+
+    std::vector<std::unique_ptr<VulkanModel>> VulkanComputeMesher::MeshChunks(const std::vector<ChunkInputs> &chunks) {
+        ReleaseFinishedBatches(false);
+
+        std::vector<std::unique_ptr<VulkanModel>> models(chunks.size());
+        if (chunks.empty()) return models;
+
+        // First pass, every chunk is meshed into scratch buffers and its face counter is copied back to the host
+        std::vector<ChunkJob> jobs(chunks.size());
+        std::vector<Dispatch> dispatches{};
+        for (size_t i = 0; i < chunks.size(); i++) {
+            ChunkJob &job = jobs[i];
+            // Block ids are read four per uint by the shader
+            job.blockBuffer = CreateInputBuffer(chunks[i].blockIds, CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH / 4);
+            job.apronBuffer = CreateInputBuffer(chunks[i].apronRows, 4 * CHUNK_DEPTH);
+            job.scratchFaceBuffer = std::make_unique<VulkanBuffer>(engineDevice_, sizeof(uint32_t), initialFaceCapacity_,
+                                                                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            job.scratchIndirectBuffer = std::make_unique<VulkanBuffer>(engineDevice_, sizeof(VulkanModel::IndirectFaceDraw), 1,
+                                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                                                       VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                                       VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            job.descriptorSets.push_back(WriteMeshDescriptorSet(*job.blockBuffer, *job.apronBuffer, *job.scratchFaceBuffer, *job.scratchIndirectBuffer));
+            dispatches.push_back({job.descriptorSets.back(), job.scratchIndirectBuffer->GetBuffer(), initialFaceCapacity_});
+        }
+
+        VulkanBuffer countBuffer{
+                engineDevice_,
+                sizeof(uint32_t),
+                static_cast<uint32_t>(chunks.size()),
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        };
+
+        VkCommandBuffer countCommands = BeginBatch();
+        RecordDispatches(countCommands, dispatches);
+
+        // Also orders the scratch face reads of the second pass after the dispatches
+        VkMemoryBarrier meshBarrier{};
+        meshBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        meshBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        meshBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(countCommands, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &meshBarrier, 0, nullptr, 0, nullptr);
+
+        for (size_t i = 0; i < chunks.size(); i++) {
+            VkBufferCopy counterCopy{};
+            counterCopy.srcOffset = offsetof(VulkanModel::IndirectFaceDraw, faceCounter);
+            counterCopy.dstOffset = i * sizeof(uint32_t);
+            counterCopy.size = sizeof(uint32_t);
+            vkCmdCopyBuffer(countCommands, jobs[i].scratchIndirectBuffer->GetBuffer(), countBuffer.GetBuffer(), 1, &counterCopy);
+        }
+
+        VkMemoryBarrier readbackBarrier{};
+        readbackBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        readbackBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        readbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(countCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &readbackBarrier, 0, nullptr, 0, nullptr);
+
+        VkFence countFence = SubmitBatch(countCommands);
+        vkWaitForFences(engineDevice_.GetDevice(), 1, &countFence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(engineDevice_.GetDevice(), countFence, nullptr);
+        vkFreeCommandBuffers(engineDevice_.GetDevice(), engineDevice_.GetCommandPool(), 1, &countCommands);
+
+        // The counters keep counting past the scratch capacity, so they hold the face count of every chunk
+        std::vector<uint32_t> faceCounts(chunks.size());
+        countBuffer.Map();
+        std::memcpy(faceCounts.data(), countBuffer.GetMappedMemory(), sizeof(uint32_t) * faceCounts.size());
+        countBuffer.Unmap();
+
+        // Second pass, models sized to the counts take the scratch faces or are meshed again when the scratch buffer was too small
+        VkCommandBuffer fillCommands = BeginBatch();
+        std::vector<Dispatch> overflowDispatches{};
+        for (size_t i = 0; i < chunks.size(); i++) {
+            const uint32_t faceCount = faceCounts[i];
+            if (faceCount == 0) continue;
+
+            models[i] = std::make_unique<VulkanModel>(engineDevice_, faceCount, faceSetLayout_, descriptorPool_);
+            if (faceCount > initialFaceCapacity_) {
+                ChunkJob &job = jobs[i];
+                job.descriptorSets.push_back(WriteMeshDescriptorSet(*job.blockBuffer, *job.apronBuffer, *models[i]->GetFaceBuffer(), *models[i]->GetIndirectBuffer()));
+                overflowDispatches.push_back({job.descriptorSets.back(), models[i]->GetIndirectBuffer()->GetBuffer(), faceCount});
+                continue;
+            }
+
+            VkBufferCopy faceCopy{};
+            faceCopy.size = sizeof(uint32_t) * faceCount;
+            vkCmdCopyBuffer(fillCommands, jobs[i].scratchFaceBuffer->GetBuffer(), models[i]->GetFaceBuffer()->GetBuffer(), 1, &faceCopy);
+
+            VulkanModel::IndirectFaceDraw indirectDraw{};
+            indirectDraw.command.vertexCount = faceCount * 6;
+            indirectDraw.command.instanceCount = 1;
+            indirectDraw.faceCounter = faceCount;
+            vkCmdUpdateBuffer(fillCommands, models[i]->GetIndirectBuffer()->GetBuffer(), 0, sizeof(indirectDraw), &indirectDraw);
+        }
+        if (!overflowDispatches.empty()) {
+            CORE_TRACE("{} chunks exceeded {} faces and are meshed again\n", overflowDispatches.size(), initialFaceCapacity_);
+            RecordDispatches(fillCommands, overflowDispatches);
+        }
+
+        // Draws and face count reads recorded later on the queue see the filled models
+        VkMemoryBarrier fillBarrier{};
+        fillBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        fillBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        fillBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(fillCommands, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &fillBarrier, 0,
+                             nullptr, 0, nullptr);
+
+        VkFence fillFence = SubmitBatch(fillCommands);
+        inFlightBatches_.push_back({fillCommands, fillFence, std::move(jobs)});
+
+        return models;
+    }
+
+    std::unique_ptr<VulkanModel> VulkanComputeMesher::MeshChunk(const unsigned char *blockIds, const uint32_t *apronRows) {
+        return std::move(MeshChunks({{blockIds, apronRows}}).front());
+    }
+
+    uint32_t VulkanComputeMesher::ReadFaceCount(const VulkanModel &model) {
+        CORE_ASSERT(model.GetIndirectBuffer() != nullptr, "Only models made by MeshChunk have a face counter")
+
+        VulkanBuffer stagingBuffer{
+                engineDevice_,
+                sizeof(VulkanModel::IndirectFaceDraw),
+                1,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        };
+        engineDevice_.CopyBuffer(model.GetIndirectBuffer()->GetBuffer(), stagingBuffer.GetBuffer(), sizeof(VulkanModel::IndirectFaceDraw));
+
+        stagingBuffer.Map();
+        VulkanModel::IndirectFaceDraw indirectDraw{};
+        std::memcpy(&indirectDraw, stagingBuffer.GetMappedMemory(), sizeof(indirectDraw));
+        stagingBuffer.Unmap();
+
+        return indirectDraw.faceCounter;
+    }
+}
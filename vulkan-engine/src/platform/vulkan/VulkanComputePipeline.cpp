@@ -0,0 +1,56 @@
+#include <platform/vulkan/VulkanComputePipeline.h>
+#include <platform/vulkan/VulkanPipeline.h>
+
+namespace VulkanEngine {
+
+    VulkanComputePipeline::VulkanComputePipeline(VulkanDevice &engineDevice, const std::string &compFilePath, VkPipelineLayout pipelineLayout)
+            : engineDevice_{engineDevice} {
+        CreateComputePipeline(compFilePath, pipelineLayout);
+    }
+
+    VulkanComputePipeline::~VulkanComputePipeline() {
+        vkDestroyShaderModule(engineDevice_.GetDevice(), compShaderModule_, nullptr);
+        vkDestroyPipeline(engineDevice_.GetDevice(), computePipeline_, nullptr);
+    }
+
+    void VulkanComputePipeline::CreateComputePipeline(const std::string &compFilePath, VkPipelineLayout pipelineLayout) {
+        auto compCode = VulkanPipeline::ReadFile(compFilePath);
+
+        CORE_INFO("Compute shader code size: {}", compCode.size());
+        CreateShaderModule(compCode, &compShaderModule_);
+
+        VkPipelineShaderStageCreateInfo shaderStage{};
+        shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        shaderStage.module = compShaderModule_;
+        shaderStage.pName = "main";
+        shaderStage.flags = 0;
+        shaderStage.pNext = nullptr;
+        shaderStage.pSpecializationInfo = nullptr;
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = shaderStage;
+        pipelineInfo.layout = pipelineLayout;
+
+        pipelineInfo.basePipelineIndex = -1;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        VkResult result = vkCreateComputePipelines(engineDevice_.GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline_);
+        CORE_ASSERT(result == VK_SUCCESS, "Failed to create compute pipeline!")
+    }
+
+    void VulkanComputePipeline::CreateShaderModule(const std::vector<char> &code, VkShaderModule *shaderModule) {
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size();
+        createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+
+        VkResult result = vkCreateShaderModule(engineDevice_.GetDevice(), &createInfo, nullptr, shaderModule);
+        CORE_ASSERT(result == VK_SUCCESS, "Failed to create shader module")
+    }
+
+    void VulkanComputePipeline::Bind(VkCommandBuffer commandBuffer) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline_);
+    }
+}
@@ -2,6 +2,7 @@
 // Created by standa on 5.3.23.
 //
 #include <platform/vulkan/VulkanContext.h>
+#include <profiling/ChunkBenchmarks.h>
 #include <imgui_impl_vulkan.h>
 
 namespace VulkanEngine {
@@ -27,17 +28,56 @@ namespace VulkanEngine {
                 .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1000)
                 .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1000)
                 .AddPoolSize(VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1000)
+                .SetPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)
                 .Build();
 
         globalSetLayout_ = VulkanDescriptorSetLayout::Builder(*vulkanDevice_)
                 .AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
                 .Build();
 
+        // Per chunk face records for vertex pulling, bound as set 1
+        terrainFaceSetLayout_ = VulkanDescriptorSetLayout::Builder(*vulkanDevice_)
+                .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+                .Build();
+
         renderSystem_ = std::make_unique<VulkanRenderSystem>(*vulkanDevice_, vulkanRenderer_->GetSwapChainRenderPass(), globalSetLayout_->GetDescriptorSetLayout(),
                                                              VK_POLYGON_MODE_FILL,
                                                              VK_CULL_MODE_BACK_BIT);
+        terrainRenderSystem_ = std::make_unique<VulkanRenderSystem>(*vulkanDevice_, vulkanRenderer_->GetSwapChainRenderPass(), globalSetLayout_->GetDescriptorSetLayout(),
+                                                                    VK_POLYGON_MODE_FILL,
+                                                                    VK_CULL_MODE_BACK_BIT,
+                                                                    VulkanModel::VERTEX_FORMAT_TERRAIN);
+        terrainFaceRenderSystem_ = std::make_unique<VulkanRenderSystem>(*vulkanDevice_, vulkanRenderer_->GetSwapChainRenderPass(), globalSetLayout_->GetDescriptorSetLayout(),
+                                                                        VK_POLYGON_MODE_FILL,
+                                                                        VK_CULL_MODE_BACK_BIT,
+                                                                        VulkanModel::VERTEX_FORMAT_TERRAIN_FACES,
+                                                                        terrainFaceSetLayout_->GetDescriptorSetLayout());
         pointLightSystem_ = std::make_unique<VulkanPointLightSystem>(*vulkanDevice_, vulkanRenderer_->GetSwapChainRenderPass(), globalSetLayout_->GetDescriptorSetLayout());
 
+        // Shared by every chunk model, sized for the largest mesh a chunk can have
+        quadIndexBuffer_ = VulkanModel::CreateQuadIndexBuffer(*vulkanDevice_, CHUNK_MAX_QUADS);
+
+        if (CHUNK_MESHING_GPU) {
+            if (vulkanDevice_->GraphicsQueueSupportsCompute()) {
+                computeMesher_ = std::make_unique<VulkanComputeMesher>(*vulkanDevice_, *terrainFaceSetLayout_, *globalPool_, CHUNK_GPU_INITIAL_FACES);
+                if (!ChunkBenchmarks::verifyComputeMesher(*computeMesher_)) {
+                    CORE_WARN("Compute mesher disagrees with the CPU kernels, chunks are meshed on the CPU");
+                    computeMesher_.reset();
+                }
+            } else {
+                CORE_WARN("Graphics queue does not support compute, chunks are meshed on the CPU");
+            }
+        }
+
+        if (CHUNK_BENCHMARKS) {
+            ChunkBenchmarks::runAll();
+        }
+        if (ChunkManager::isMapAvailable()) {
+            chunkManager_ = std::make_unique<ChunkManager>(*vulkanDevice_, quadIndexBuffer_, *terrainFaceSetLayout_, *globalPool_, computeMesher_.get());
+        } else {
+            CORE_ERROR("Map database {} not found, running without chunk streaming", ChunkDeserializer::DATABASE_PATH);
+        }
+
         for (auto &uboBuffer: uboBuffers) {
             uboBuffer = std::make_unique<VulkanBuffer>(
                     *vulkanDevice_,
@@ -122,6 +162,8 @@ namespace VulkanEngine {
     }
 
     VkCommandBuffer VulkanContext::BeginFrame() {
+        LoadChunkGameObjects(fromCameraToWorld(camera.GetPosition()));
+
         auto commandBuffer = vulkanRenderer_->BeginFrame();
 
         camera.SetPerspectiveProjection(glm::radians(60.f), vulkanRenderer_->GetAspectRatio(), 0.1f, 1000.f);
@@ -140,6 +182,8 @@ namespace VulkanEngine {
         vulkanRenderer_->BeginSwapChainRenderPass(commandBuffer);
 
         renderSystem_->RenderGameObjects(frameInfo);
+        terrainRenderSystem_->RenderGameObjects(frameInfo);
+        terrainFaceRenderSystem_->RenderGameObjects(frameInfo);
         pointLightSystem_->Render(frameInfo);
 
         return commandBuffer;
@@ -149,4 +193,77 @@ namespace VulkanEngine {
         vulkanRenderer_->EndSwapChainRenderPass(commandBuffer);
         vulkanRenderer_->EndFrame();
     }
+
+    void VulkanContext::LoadChunkGameObjects(glm::vec3 playerPosition) {
+        // Invalidated objects are kept until no frame in flight can draw them
+        for (auto it = gameObjects.begin(); it != gameObjects.end();) {
+            it->second.TickInvalidation();
+            it = it->second.ShouldBeDestroyed() ? gameObjects.erase(it) : std::next(it);
+        }
+
+        for (auto &retired: retiredChunkModels_) { retired.second++; }
+        retiredChunkModels_.erase(std::remove_if(retiredChunkModels_.begin(), retiredChunkModels_.end(), [](const auto &retired) {
+            return retired.second > VulkanSwapChain::MAX_FRAMES_IN_FLIGHT;
+        }), retiredChunkModels_.end());
+
+        if (chunkManager_ == nullptr) return;
+        chunkManager_->loadChunksAroundPlayerAsync(playerPosition, CHUNK_LOAD_DISTANCE);
+
+        // Models of the chunks meshed since the last frame are created together, chunks meshed on the GPU share one batch. The
+        // flag is set for remeshed chunks.
+        std::vector<std::pair<Chunk *, bool>> meshedChunks{};
+        std::vector<ChunkPrefab> prefabs{};
+
+        for (auto &kv: chunkManager_->getVisibleChunks()) {
+            Chunk &chunk = kv.second;
+            chunk_state state = chunk.getChunkState();
+            if (state == CHUNK_STATE_ACTIVE) {
+                if (!chunk.checkIfPrefabReady()) continue;
+
+                meshedChunks.emplace_back(&chunk, false);
+                prefabs.push_back(chunk.takePrefab());
+            } else if (state == CHUNK_STATE_VISIBLE) {
+                // Empty chunks have no game objects to invalidate or remesh
+                if (chunk.isEmpty()) {
+                    if (chunk.isTimedOut()) { chunk.invalidate(); }
+                    continue;
+                }
+
+                if (chunk.isTimedOut()) {
+                    auto obj = gameObjects.find(chunk.getGameObjectId());
+                    if (obj != gameObjects.end()) { obj->second.Invalidate(); }
+                    chunk.invalidate();
+                } else if (chunk.hasPendingRemesh() && chunk.checkIfRemeshReady()) {
+                    // Taking the prefab clears the pending remesh even without an object, so the chunk can be remeshed again
+                    meshedChunks.emplace_back(&chunk, true);
+                    prefabs.push_back(chunk.takeRemeshedPrefab());
+                }
+            }
+        }
+        if (prefabs.empty()) return;
+
+        std::vector<std::shared_ptr<VulkanModel>> models = Chunk::acquireModels(*vulkanDevice_, chunkManager_->getModelCache(), prefabs);
+        for (size_t i = 0; i < meshedChunks.size(); i++) {
+            auto [chunk, remeshed] = meshedChunks[i];
+            if (remeshed) {
+                // Swap in the mesh rebuilt with the current neighbors
+                auto obj = gameObjects.find(chunk->getGameObjectId());
+                if (obj != gameObjects.end()) {
+                    retiredChunkModels_.emplace_back(std::move(obj->second.model), 0);
+                    obj->second.model = std::move(models[i]);
+                }
+                continue;
+            }
+
+            VulkanGameObject chunkGameObject = chunk->createGameObject(std::move(models[i]));
+
+            // A chunk requested again right after timing out still has its invalidated object waiting for the frames in
+            // flight, the new object replaces it and the old model is retired instead
+            auto stale = gameObjects.find(chunkGameObject.GetId());
+            if (stale != gameObjects.end()) {
+                retiredChunkModels_.emplace_back(std::move(stale->second.model), 0);
+            }
+            gameObjects.insert_or_assign(chunkGameObject.GetId(), std::move(chunkGameObject));
+        }
+    }
 }
\ No newline at end of file
@@ -203,6 +203,7 @@ namespace VulkanEngine {
             if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
                 indices.graphicsFamily = i;
                 indices.graphicsFamilyHasValue = true;
+                indices.graphicsFamilyHasCompute = (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
             }
             int presentSupport = glfwGetPhysicalDevicePresentationSupport(instance_, physicalDevice_, i);
             if (queueFamily.queueCount > 0 && presentSupport) {
@@ -7,6 +7,8 @@
 
 #include "tiny_obj_loader.h"
 
+#include <limits>
+
 template<typename T, typename... Rest>
 void hashCombine(std::size_t &seed, const T &v, const Rest&... rest) {
     seed ^= std::hash<T>{}(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
@@ -26,14 +28,123 @@ namespace std {
 
 namespace VulkanEngine {
 
+    // Model space bounds of the different vertex formats, used to reject face ranges that cannot face the camera
+    static void GetVertexBounds(const std::vector<VulkanModel::Vertex> &vertices, glm::vec3 &boundsMin, glm::vec3 &boundsMax) {
+        boundsMin = glm::vec3{std::numeric_limits<float>::max()};
+        boundsMax = glm::vec3{std::numeric_limits<float>::lowest()};
+        for (const auto &vertex: vertices) {
+            boundsMin = glm::min(boundsMin, vertex.position);
+            boundsMax = glm::max(boundsMax, vertex.position);
+        }
+    }
+
+    static void GetVertexBounds(const std::vector<VulkanModel::TerrainVertex> &vertices, glm::vec3 &boundsMin, glm::vec3 &boundsMax) {
+        boundsMin = glm::vec3{std::numeric_limits<float>::max()};
+        boundsMax = glm::vec3{std::numeric_limits<float>::lowest()};
+        for (const auto &vertex: vertices) {
+            // Same mapping as fromWorldToCamera and shaders/terrain.vert
+            const glm::vec3 position{(float) ((vertex.position >> 6) & 0x3Fu), -(float) ((vertex.position >> 12) & 0x1FFu), (float) (vertex.position & 0x3Fu)};
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+    }
+
+    static void GetFaceBounds(const std::vector<uint32_t> &faces, glm::vec3 &boundsMin, glm::vec3 &boundsMax) {
+        boundsMin = glm::vec3{std::numeric_limits<float>::max()};
+        boundsMax = glm::vec3{std::numeric_limits<float>::lowest()};
+        for (uint32_t face: faces) {
+            // Whole voxel of the face, same mapping as shaders/terrain_faces.vert
+            const glm::vec3 voxelMin{(float) ((face >> 5) & 0x1Fu), -(float) ((face >> 10) & 0xFFu) - 1.f, (float) (face & 0x1Fu)};
+            boundsMin = glm::min(boundsMin, voxelMin);
+            boundsMax = glm::max(boundsMax, voxelMin + 1.f);
+        }
+    }
+
     VulkanModel::VulkanModel(VulkanDevice &device, const VulkanModel::Builder &builder) : engineDevice_{device} {
         CreateVertexBuffer(builder.vertices);
         CreateIndexBuffer(builder.indices);
+        if (!builder.faceRanges.empty()) {
+            glm::vec3 boundsMin, boundsMax;
+            GetVertexBounds(builder.vertices, boundsMin, boundsMax);
+            SetFaceRanges(builder.faceRanges, boundsMin, boundsMax);
+        }
     }
 
-    VulkanModel::~VulkanModel() = default;
+    VulkanModel::VulkanModel(VulkanDevice &device, const VulkanModel::TerrainBuilder &builder) : engineDevice_{device}, vertexFormat_{VERTEX_FORMAT_TERRAIN} {
+        CreateVertexBuffer(builder.vertices);
+        CreateIndexBuffer(builder.indices);
+        if (!builder.faceRanges.empty()) {
+            glm::vec3 boundsMin, boundsMax;
+            GetVertexBounds(builder.vertices, boundsMin, boundsMax);
+            SetFaceRanges(builder.faceRanges, boundsMin, boundsMax);
+        }
+    }
+
+    VulkanModel::VulkanModel(VulkanDevice &device, const VulkanModel::Builder &builder, std::shared_ptr<VulkanBuffer> quadIndexBuffer) : engineDevice_{device} {
+        CreateVertexBuffer(builder.vertices);
+        UseQuadIndexBuffer(std::move(quadIndexBuffer));
+        if (!builder.faceRanges.empty()) {
+            glm::vec3 boundsMin, boundsMax;
+            GetVertexBounds(builder.vertices, boundsMin, boundsMax);
+            SetFaceRanges(builder.faceRanges, boundsMin, boundsMax);
+        }
+    }
+
+    VulkanModel::VulkanModel(VulkanDevice &device, const VulkanModel::TerrainBuilder &builder, std::shared_ptr<VulkanBuffer> quadIndexBuffer)
+            : engineDevice_{device}, vertexFormat_{VERTEX_FORMAT_TERRAIN} {
+        CreateVertexBuffer(builder.vertices);
+        UseQuadIndexBuffer(std::move(quadIndexBuffer));
+        if (!builder.faceRanges.empty()) {
+            glm::vec3 boundsMin, boundsMax;
+            GetVertexBounds(builder.vertices, boundsMin, boundsMax);
+            SetFaceRanges(builder.faceRanges, boundsMin, boundsMax);
+        }
+    }
+
+    VulkanModel::VulkanModel(VulkanDevice &device, const VulkanModel::FaceBuilder &builder, VulkanDescriptorSetLayout &faceSetLayout,
+                             VulkanDescriptorPool &descriptorPool) : engineDevice_{device}, vertexFormat_{VERTEX_FORMAT_TERRAIN_FACES}, descriptorPool_{&descriptorPool} {
+        CreateFaceBuffer(builder.faces);
+        if (!builder.faceRanges.empty()) {
+            glm::vec3 boundsMin, boundsMax;
+            GetFaceBounds(builder.faces, boundsMin, boundsMax);
+            SetFaceRanges(builder.faceRanges, boundsMin, boundsMax);
+        }
+        AllocateFaceDescriptorSet(faceSetLayout);
+    }
+
+    VulkanModel::VulkanModel(VulkanDevice &device, uint32_t faceCapacity, VulkanDescriptorSetLayout &faceSetLayout, VulkanDescriptorPool &descriptorPool)
+            : engineDevice_{device}, vertexFormat_{VERTEX_FORMAT_TERRAIN_FACES}, descriptorPool_{&descriptorPool} {
+        CORE_ASSERT(faceCapacity > 0, "Face capacity must be at least 1")
+        faceCount_ = faceCapacity;
+
+        faceBuffer_ = std::make_unique<VulkanBuffer>(
+                engineDevice_,
+                sizeof(uint32_t),
+                faceCapacity,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+        indirectBuffer_ = std::make_unique<VulkanBuffer>(
+                engineDevice_,
+                sizeof(IndirectFaceDraw),
+                1,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+        AllocateFaceDescriptorSet(faceSetLayout);
+    }
+
+    VulkanModel::~VulkanModel() {
+        if (faceDescriptorSet_ != VK_NULL_HANDLE) {
+            std::vector<VkDescriptorSet> descriptorSets{faceDescriptorSet_};
+            descriptorPool_->FreeDescriptors(descriptorSets);
+        }
+    }
 
     void VulkanModel::Bind(VkCommandBuffer commandBuffer) {
+        // Face models have no vertex input, their records are bound through GetFaceDescriptorSet
+        if (vertexFormat_ == VERTEX_FORMAT_TERRAIN_FACES) return;
+
         VkBuffer buffers[] = {vertexBuffer_->GetBuffer()};
         VkDeviceSize offsets[] = {0};
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
@@ -44,14 +155,57 @@ namespace VulkanEngine {
     }
 
     void VulkanModel::Draw(VkCommandBuffer commandBuffer) const {
-        if (hasIndexBuffer_) {
+        if (indirectBuffer_) {
+            vkCmdDrawIndirect(commandBuffer, indirectBuffer_->GetBuffer(), 0, 1, sizeof(VkDrawIndirectCommand));
+        } else if (vertexFormat_ == VERTEX_FORMAT_TERRAIN_FACES) {
+            vkCmdDraw(commandBuffer, faceCount_ * 6, 1, 0, 0);
+        } else if (hasIndexBuffer_) {
             vkCmdDrawIndexed(commandBuffer, indexCount_, 1, 0, 0, 0);
         } else {
             vkCmdDraw(commandBuffer, vertexCount_, 1, 0, 0);
         }
     }
 
-    void VulkanModel::CreateVertexBuffer(const std::vector<Vertex> &vertices) {
+    void VulkanModel::DrawFaceRanges(VkCommandBuffer commandBuffer, uint32_t directionMask) const {
+        uint32_t firstFace = 0;
+        uint32_t faceCount = 0;
+
+        for (uint32_t direction = 0; direction < faceRanges_.size(); direction++) {
+            const FaceRange &range = faceRanges_[direction];
+            if (!(directionMask & (1u << direction)) || range.faceCount == 0) continue;
+
+            if (faceCount != 0 && firstFace + faceCount == range.firstFace) {
+                faceCount += range.faceCount;
+                continue;
+            }
+
+            DrawFaces(commandBuffer, firstFace, faceCount);
+            firstFace = range.firstFace;
+            faceCount = range.faceCount;
+        }
+
+        DrawFaces(commandBuffer, firstFace, faceCount);
+    }
+
+    void VulkanModel::DrawFaces(VkCommandBuffer commandBuffer, uint32_t firstFace, uint32_t faceCount) const {
+        if (faceCount == 0) return;
+
+        if (vertexFormat_ == VERTEX_FORMAT_TERRAIN_FACES) {
+            vkCmdDraw(commandBuffer, faceCount * 6, 1, firstFace * 6, 0);
+        } else {
+            CORE_ASSERT(hasIndexBuffer_, "Face ranges of vertex models require an index buffer")
+            vkCmdDrawIndexed(commandBuffer, faceCount * 6, 1, firstFace * 6, 0, 0);
+        }
+    }
+
+    void VulkanModel::SetFaceRanges(const std::vector<FaceRange> &faceRanges, glm::vec3 boundsMin, glm::vec3 boundsMax) {
+        faceRanges_ = faceRanges;
+        boundsMin_ = boundsMin;
+        boundsMax_ = boundsMax;
+    }
+
+    template<typename T>
+    void VulkanModel::CreateVertexBuffer(const std::vector<T> &vertices) {
         vertexCount_ = static_cast<uint32_t>(vertices.size());
         assert(vertexCount_ >= 3 && " Vertex count must be at least 3");
 
@@ -111,6 +265,87 @@ namespace VulkanEngine {
 
     }
 
+    void VulkanModel::UseQuadIndexBuffer(std::shared_ptr<VulkanBuffer> quadIndexBuffer) {
+        CORE_ASSERT(vertexCount_ % 4 == 0, "Quad based model must have 4 vertices per quad")
+        indexCount_ = vertexCount_ / 4 * 6;
+        CORE_ASSERT(indexCount_ <= quadIndexBuffer->GetInstanceCount(), "Model has more quads than the shared quad index buffer holds")
+
+        indexBuffer_ = std::move(quadIndexBuffer);
+        hasIndexBuffer_ = true;
+    }
+
+    std::shared_ptr<VulkanBuffer> VulkanModel::CreateQuadIndexBuffer(VulkanDevice &device, uint32_t maxQuads) {
+        std::vector<uint32_t> indices{};
+        indices.reserve(maxQuads * 6);
+        for (uint32_t quad = 0; quad < maxQuads; quad++) {
+            uint32_t offset = quad * 4;
+            indices.insert(indices.end(), {offset, offset + 1, offset + 2, offset + 2, offset + 3, offset});
+        }
+
+        auto indexCount = static_cast<uint32_t>(indices.size());
+        VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
+        uint32_t indexSize = sizeof indices[0];
+
+        VulkanBuffer stagingBuffer{
+                device,
+                indexSize,
+                indexCount,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        };
+
+        stagingBuffer.Map();
+        stagingBuffer.WriteToBuffer((void *) indices.data());
+
+        auto quadIndexBuffer = std::make_shared<VulkanBuffer>(
+                device,
+                indexSize,
+                indexCount,
+                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+
+        device.CopyBuffer(stagingBuffer.GetBuffer(), quadIndexBuffer->GetBuffer(), bufferSize);
+        return quadIndexBuffer;
+    }
+
+    void VulkanModel::AllocateFaceDescriptorSet(VulkanDescriptorSetLayout &faceSetLayout) {
+        auto bufferInfo = faceBuffer_->DescriptorInfo();
+        bool allocated = VulkanDescriptorWriter(faceSetLayout, *descriptorPool_)
+                .WriteBuffer(0, &bufferInfo)
+                .Build(faceDescriptorSet_);
+        CORE_ASSERT(allocated, "Failed to allocate face descriptor set!")
+    }
+
+    void VulkanModel::CreateFaceBuffer(const std::vector<uint32_t> &faces) {
+        faceCount_ = static_cast<uint32_t>(faces.size());
+        CORE_ASSERT(faceCount_ > 0, "Face count must be at least 1")
+
+        VkDeviceSize bufferSize = sizeof(faces[0]) * faceCount_;
+        uint32_t faceSize = sizeof faces[0];
+
+        VulkanBuffer stagingBuffer{
+                engineDevice_,
+                faceSize,
+                faceCount_,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        };
+
+        stagingBuffer.Map();
+        stagingBuffer.WriteToBuffer((void *) faces.data());
+
+        faceBuffer_ = std::make_unique<VulkanBuffer>(
+                engineDevice_,
+                faceSize,
+                faceCount_,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+
+        engineDevice_.CopyBuffer(stagingBuffer.GetBuffer(), faceBuffer_->GetBuffer(), bufferSize);
+    }
+
     std::vector<VkVertexInputBindingDescription> VulkanModel::Vertex::GetBindingDescriptions() {
         std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
         bindingDescriptions[0].binding = 0;
@@ -130,6 +365,40 @@ namespace VulkanEngine {
         return attributeDescriptions;
     }
 
+    VulkanModel::TerrainVertex VulkanModel::TerrainVertex::Pack(glm::uvec3 localPosition, uint32_t normalIndex, uint32_t colorIndex) {
+        CORE_ASSERT(localPosition.x <= 63 && localPosition.y <= 63 && localPosition.z <= 511, "Terrain vertex position out of packable range")
+        CORE_ASSERT(normalIndex < 6 && colorIndex <= 255, "Terrain vertex attributes out of packable range")
+
+        TerrainVertex vertex{};
+        vertex.position = localPosition.x | (localPosition.y << 6) | (localPosition.z << 12);
+        vertex.attributes = normalIndex | (colorIndex << 3);
+        return vertex;
+    }
+
+    std::vector<VkVertexInputBindingDescription> VulkanModel::TerrainVertex::GetBindingDescriptions() {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].stride = sizeof(TerrainVertex);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescriptions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> VulkanModel::TerrainVertex::GetAttributeDescriptions() {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+        attributeDescriptions.push_back({0, 0, VK_FORMAT_R32_UINT, offsetof(TerrainVertex, position)});
+        attributeDescriptions.push_back({1, 0, VK_FORMAT_R32_UINT, offsetof(TerrainVertex, attributes)});
+
+        return attributeDescriptions;
+    }
+
+    uint32_t VulkanModel::FaceBuilder::PackFace(glm::uvec3 localPosition, uint32_t direction, uint32_t blockType) {
+        CORE_ASSERT(localPosition.x <= 31 && localPosition.y <= 31 && localPosition.z <= 255, "Face position out of packable range")
+        CORE_ASSERT(direction < 6 && blockType <= 255, "Face attributes out of packable range")
+
+        return localPosition.x | (localPosition.y << 5) | (localPosition.z << 10) | (direction << 18) | (blockType << 21);
+    }
+
     std::unique_ptr<VulkanModel> VulkanModel::CreateModelFromFile(VulkanDevice &device, const std::string &filepath) {
         Builder builder{};
         builder.LoadModel(filepath);
@@ -7,24 +7,30 @@
 namespace VulkanEngine {
 
     VulkanRenderSystem::VulkanRenderSystem(VulkanDevice &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkPolygonMode polygonMode,
-                                           VkCullModeFlagBits cullMode) : engineDevice_{device} {
-        CreatePipelineLayout(globalSetLayout);
+                                           VkCullModeFlagBits cullMode, VulkanModel::VertexFormat vertexFormat, VkDescriptorSetLayout faceSetLayout)
+            : engineDevice_{device}, vertexFormat_{vertexFormat} {
+        CORE_ASSERT(vertexFormat != VulkanModel::VERTEX_FORMAT_TERRAIN_FACES || faceSetLayout != VK_NULL_HANDLE, "Terrain face rendering requires a face set layout")
+        CreatePipelineLayout(globalSetLayout, faceSetLayout);
         CreatePipeline(renderPass, polygonMode, cullMode);
 
         isWireFrame_ = polygonMode == VK_POLYGON_MODE_LINE;
+        cullsBackFaces_ = (cullMode & VK_CULL_MODE_BACK_BIT) != 0;
     }
 
     VulkanRenderSystem::~VulkanRenderSystem() {
         vkDestroyPipelineLayout(engineDevice_.GetDevice(), pipelineLayout_, nullptr);
     }
 
-    void VulkanRenderSystem::CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+    void VulkanRenderSystem::CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout faceSetLayout) {
         VkPushConstantRange pushConstantRange = {};
         pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
         pushConstantRange.offset = 0;
         pushConstantRange.size = sizeof(SimplePushConstants);
 
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout};
+        if (faceSetLayout != VK_NULL_HANDLE) {
+            descriptorSetLayouts.push_back(faceSetLayout);
+        }
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -45,6 +51,18 @@ namespace VulkanEngine {
         pipelineConfig.rasterizationInfo.polygonMode = polygonMode;
         pipelineConfig.rasterizationInfo.cullMode = cullMode;
 
+        std::string vertex_shader = "shaders/shader.vert.spv";
+        if (vertexFormat_ == VulkanModel::VERTEX_FORMAT_TERRAIN) {
+            pipelineConfig.bindingDescriptions = VulkanModel::TerrainVertex::GetBindingDescriptions();
+            pipelineConfig.attributeDescriptions = VulkanModel::TerrainVertex::GetAttributeDescriptions();
+            vertex_shader = "shaders/terrain.vert.spv";
+        } else if (vertexFormat_ == VulkanModel::VERTEX_FORMAT_TERRAIN_FACES) {
+            // Faces are pulled from a storage buffer, there is no vertex input
+            pipelineConfig.bindingDescriptions.clear();
+            pipelineConfig.attributeDescriptions.clear();
+            vertex_shader = "shaders/terrain_faces.vert.spv";
+        }
+
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout_;
 
@@ -54,7 +72,7 @@ namespace VulkanEngine {
         } else {
             fragment_shader = "shaders/shader.frag.spv";
         }
-        enginePipeline_ = std::make_unique<VulkanPipeline>(engineDevice_, "shaders/shader.vert.spv", fragment_shader, pipelineConfig);
+        enginePipeline_ = std::make_unique<VulkanPipeline>(engineDevice_, vertex_shader, fragment_shader, pipelineConfig);
     }
 
     void VulkanRenderSystem::RenderGameObjects(FrameInfo &frameInfo) {
@@ -64,7 +82,8 @@ namespace VulkanEngine {
 
         for (auto &kv: frameInfo.gameObjects) {
             auto &obj = kv.second;
-            if (obj.model == nullptr) continue;
+            if (obj.model == nullptr || !obj.isActive) continue;
+            if (obj.model->GetVertexFormat() != vertexFormat_) continue;
 
             SimplePushConstants push = {};
             push.modelMatrix = obj.transform.Mat4();
@@ -78,8 +97,35 @@ namespace VulkanEngine {
                     sizeof(SimplePushConstants),
                     &push
             );
+            if (vertexFormat_ == VulkanModel::VERTEX_FORMAT_TERRAIN_FACES) {
+                VkDescriptorSet faceDescriptorSet = obj.model->GetFaceDescriptorSet();
+                vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout_, 1, 1, &faceDescriptorSet, 0, nullptr);
+            }
             obj.model->Bind(frameInfo.commandBuffer);
-            obj.model->Draw(frameInfo.commandBuffer);
+            if (cullsBackFaces_ && obj.model->HasFaceRanges()) {
+                const glm::vec3 cameraPosition = glm::inverse(push.modelMatrix) * glm::vec4(glm::vec3(frameInfo.camera.GetInverseView()[3]), 1.f);
+                obj.model->DrawFaceRanges(frameInfo.commandBuffer, GetVisibleDirections(*obj.model, cameraPosition));
+            } else {
+                obj.model->Draw(frameInfo.commandBuffer);
+            }
+        }
+    }
+
+    uint32_t VulkanRenderSystem::GetVisibleDirections(const VulkanModel &model, glm::vec3 cameraPosition) {
+        // Camera space axis and sign of the outward normal, indexed by Block::FaceOrientation
+        static const int axes[6] = {2, 2, 1, 1, 0, 0};
+        static const float signs[6] = {-1.f, 1.f, -1.f, 1.f, -1.f, 1.f};
+
+        const glm::vec3 boundsMin = model.GetBoundsMin();
+        const glm::vec3 boundsMax = model.GetBoundsMax();
+
+        // A face can only be front facing when the camera is in front of its plane, every plane of a direction lies inside the bounds
+        uint32_t directionMask = 0;
+        for (uint32_t direction = 0; direction < 6; direction++) {
+            const int axis = axes[direction];
+            const bool visible = signs[direction] > 0.f ? cameraPosition[axis] > boundsMin[axis] : cameraPosition[axis] < boundsMax[axis];
+            if (visible) directionMask |= 1u << direction;
         }
+        return directionMask;
     }
 }
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include "../../include/profiling/ChunkBenchmarks.h"
+#include "../../include/rendering/ChunkMesher.h"
+#include "../../include/rendering/ChunkBlockStorage.h"
+#include "../../include/rendering/ChunkRegionStore.h"
+#include "../../include/rendering/ChunkUringStore.h"
+#include <platform/vulkan/VulkanComputeMesher.h>
+
+#include <chrono>
+#include <fstream>
+#include <utility>
+
+void ChunkBenchmarks::runAll() {
+    ChunkDeserializer deserializer{};
+    benchmarkDecoding(deserializer, getPositionsAroundCenter(4), 10);
+    benchmarkLayouts(deserializer, getPositionsAroundCenter(2), 3);
+    benchmarkStores(deserializer, getPositionsAroundCenter(4), 10);
+    benchmarkKernelSizes(10);
+}
+
+void ChunkBenchmarks::benchmarkDecoding(ChunkDeserializer &deserializer, const std::vector<glm::uvec2> &positions, uint32_t iterations) {
+    static_assert(sizeof(Block) == sizeof(Block::block_id), "Blocks are stored as their raw block ids");
+    const ChunkMesher::KernelTable *kernels = ChunkMesher::findKernelTable(CHUNK_SIZE);
+    const size_t volume = CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH;
+
+    std::vector<ChunkStore::ChunkPayload> payloads = deserializer.readChunkPayloads(positions);
+    std::vector<Block> blocks(volume);
+
+    // The checksum keeps the decoded blocks observable, both paths have to agree on it
+    uint64_t twoStageChecksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (const auto &payload: payloads) {
+            ChunkStore::RawChunkData rawData = ChunkEncoding::isEncoded(payload.data(), payload.size())
+                                               ? ChunkDeserializer::decodeBinaryChunk(payload.data(), payload.size())
+                                               : ChunkDeserializer::decodeTextChunk({payload.begin(), payload.end()});
+            if (rawData.size() != volume) continue;
+            kernels->decodeBlocks(rawData.data(), blocks.data());
+            twoStageChecksum += blocks[volume / 2].getBlockId();
+        }
+    }
+    std::chrono::duration<float> twoStage = std::chrono::steady_clock::now() - start;
+
+    uint64_t directChecksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (const auto &payload: payloads) {
+            auto *ids = reinterpret_cast<Block::block_id *>(blocks.data());
+            if (!ChunkEncoding::decodeAnyFormat(payload.data(), payload.size(), ids, volume)) continue;
+            directChecksum += blocks[volume / 2].getBlockId();
+        }
+    }
+    std::chrono::duration<float> direct = std::chrono::steady_clock::now() - start;
+
+    ChunkBlockStorage storage{};
+    uint64_t packedChecksum = 0;
+    size_t packedBytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (const auto &payload: payloads) {
+            if (!storage.assignEncoded(payload.data(), payload.size())) continue;
+            packedChecksum += storage.getBlockId(volume / 2);
+            packedBytes += storage.getMemoryUsage();
+        }
+    }
+    std::chrono::duration<float> packed = std::chrono::steady_clock::now() - start;
+
+    const float decodes = static_cast<float>(payloads.size() * iterations);
+    CORE_INFO("Decoding {} chunks {} times: two stage {} ms ({} ms per chunk), direct {} ms ({} ms per chunk), packed {} ms ({} ms per chunk)\n",
+              payloads.size(), iterations,
+              twoStage.count() * 1000, twoStage.count() * 1000 / decodes,
+              direct.count() * 1000, direct.count() * 1000 / decodes,
+              packed.count() * 1000, packed.count() * 1000 / decodes);
+    CORE_INFO("Packed storage holds {} bytes per chunk on average instead of {}\n", decodes > 0 ? packedBytes / static_cast<size_t>(decodes) : 0, volume);
+    if (twoStageChecksum != directChecksum || directChecksum != packedChecksum) {
+        CORE_ERROR("Decoding paths disagree, checksums {}, {} and {}\n", twoStageChecksum, directChecksum, packedChecksum);
+    }
+}
+
+void ChunkBenchmarks::benchmarkLayouts(ChunkDeserializer &deserializer, const std::vector<glm::uvec2> &positions, uint32_t iterations) {
+    using Kernels = ChunkMesher::Kernels;
+    using Clock = std::chrono::steady_clock;
+    const std::vector<ChunkStore::ChunkPayload> payloads = deserializer.readChunkPayloads(positions);
+
+    // Quad and exposed block counts have to match between the layouts
+    uint64_t checksums[2] = {};
+    for (auto layout: {ChunkBlockStorage::LINEAR, ChunkBlockStorage::MORTON}) {
+        std::vector<ChunkBlockStorage> storages(payloads.size(), ChunkBlockStorage{layout});
+        uint64_t &checksum = checksums[layout];
+
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            for (size_t c = 0; c < payloads.size(); c++) {
+                storages[c].assignEncoded(payloads[c].data(), payloads[c].size());
+            }
+        }
+        std::chrono::duration<float> packing = Clock::now() - start;
+
+        std::chrono::duration<float> meshing[2] = {};
+        for (bool greedy: {false, true}) {
+            start = Clock::now();
+            for (uint32_t i = 0; i < iterations; i++) {
+                for (const auto &storage: storages) {
+                    checksum += Kernels::generateMesh(storage, Kernels::Apron{}, {1.0f, 1.0f, 1.0f}, greedy).vertices.size();
+                }
+            }
+            meshing[greedy] = Clock::now() - start;
+        }
+
+        // Solid blocks with an air neighbor inside the chunk, every lookup goes through getBlockId
+        start = Clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            for (const auto &storage: storages) {
+                for (uint32_t z = 1; z < CHUNK_DEPTH - 1; z++) {
+                    for (uint32_t y = 1; y < CHUNK_SIZE - 1; y++) {
+                        for (uint32_t x = 1; x < CHUNK_SIZE - 1; x++) {
+                            const uint32_t serial = Kernels::serial(x, y, z);
+                            if (storage.getBlockId(serial) != Block::BlockTypes::SOLID) continue;
+                            const bool exposed = storage.getBlockId(serial - 1) == Block::BlockTypes::AIR ||
+                                                 storage.getBlockId(serial + 1) == Block::BlockTypes::AIR ||
+                                                 storage.getBlockId(serial - CHUNK_SIZE) == Block::BlockTypes::AIR ||
+                                                 storage.getBlockId(serial + CHUNK_SIZE) == Block::BlockTypes::AIR ||
+                                                 storage.getBlockId(serial - CHUNK_SIZE * CHUNK_SIZE) == Block::BlockTypes::AIR ||
+                                                 storage.getBlockId(serial + CHUNK_SIZE * CHUNK_SIZE) == Block::BlockTypes::AIR;
+                            checksum += exposed;
+                        }
+                    }
+                }
+            }
+        }
+        std::chrono::duration<float> neighbors = Clock::now() - start;
+
+        const float chunks = static_cast<float>(payloads.size() * iterations);
+        CORE_INFO("{} layout, {} chunks {} times, per chunk: packing {} ms, per face meshing {} ms, greedy meshing {} ms, neighbor queries {} ms\n",
+                  layout == ChunkBlockStorage::MORTON ? "Morton" : "Linear", payloads.size(), iterations,
+                  packing.count() * 1000 / chunks, meshing[false].count() * 1000 / chunks, meshing[true].count() * 1000 / chunks,
+                  neighbors.count() * 1000 / chunks);
+    }
+
+    if (checksums[ChunkBlockStorage::LINEAR] != checksums[ChunkBlockStorage::MORTON]) {
+        CORE_ERROR("Block layouts disagree, checksums {} and {}\n", checksums[ChunkBlockStorage::LINEAR], checksums[ChunkBlockStorage::MORTON]);
+    }
+}
+
+void ChunkBenchmarks::benchmarkStores(ChunkDeserializer &deserializer, const std::vector<glm::uvec2> &positions, uint32_t iterations) {
+    using Clock = std::chrono::steady_clock;
+
+    const uint64_t fingerprint = ChunkRegionStore::getSourceFingerprint(ChunkDeserializer::DATABASE_PATH);
+    if (!ChunkRegionStore::isUpToDate(CHUNK_REGION_PATH, fingerprint)) {
+        CORE_INFO("Writing the region archive {} from the map database\n", CHUNK_REGION_PATH);
+        auto start = Clock::now();
+        ChunkRegionStore::writeRegionFile(CHUNK_REGION_PATH, deserializer, fingerprint);
+        std::chrono::duration<float> writing = Clock::now() - start;
+        CORE_INFO("Region archive written in {} ms\n", writing.count() * 1000);
+    }
+
+    ChunkRegionStore regionStore{CHUNK_REGION_PATH};
+    std::vector<std::pair<const char *, ChunkStore *>> stores{{"SQLite", &deserializer}, {"Region archive", &regionStore}};
+#if CHUNK_STORE_URING
+    ChunkUringStore uringStore{CHUNK_REGION_PATH};
+    stores.emplace_back("io_uring region archive", &uringStore);
+#endif
+
+    // Every store has to decode into the same blocks, the sum of the block hashes is compared
+    std::vector<uint64_t> checksums{};
+    ChunkBlockStorage storage{};
+    for (const auto &[name, store]: stores) {
+        std::chrono::duration<float> reading{};
+        std::chrono::duration<float> decoding{};
+        uint64_t checksum = 0;
+        size_t payloadBytes = 0;
+
+        for (uint32_t i = 0; i < iterations; i++) {
+            auto start = Clock::now();
+            const std::vector<ChunkStore::ChunkPayload> payloads = store->readChunkPayloads(positions);
+            reading += Clock::now() - start;
+
+            start = Clock::now();
+            for (const auto &payload: payloads) {
+                if (!storage.assignEncoded(payload.data(), payload.size())) continue;
+                checksum += storage.hash();
+                payloadBytes += payload.size();
+            }
+            decoding += Clock::now() - start;
+        }
+        checksums.push_back(checksum);
+
+        const float chunks = static_cast<float>(positions.size() * iterations);
+        CORE_INFO("{} store, {} chunks {} times, per chunk: reading {} ms, decoding {} ms, {} payload bytes\n",
+                  name, positions.size(), iterations, reading.count() * 1000 / chunks, decoding.count() * 1000 / chunks,
+                  chunks > 0 ? payloadBytes / static_cast<size_t>(chunks) : 0);
+    }
+
+    if (std::adjacent_find(checksums.begin(), checksums.end(), std::not_equal_to<>()) != checksums.end()) {
+        CORE_ERROR("Chunk stores disagree on the decoded blocks\n");
+    }
+}
+
+void ChunkBenchmarks::benchmarkKernelSizes(uint32_t iterations) {
+    using Clock = std::chrono::steady_clock;
+
+    for (uint32_t chunkSize: {16u, 32u, 64u}) {
+        const ChunkMesher::KernelTable *kernels = ChunkMesher::findKernelTable(chunkSize);
+        if (kernels == nullptr) continue;
+
+        const std::vector<Block::block_id> blockIds = generateSyntheticChunk(kernels->chunkSize, kernels->chunkDepth);
+        std::vector<Block> blocks(blockIds.size());
+
+        auto start = Clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            kernels->decodeBlocks(blockIds.data(), blocks.data());
+        }
+        std::chrono::duration<float> decoding = Clock::now() - start;
+
+        std::chrono::duration<float> meshing[2] = {};
+        size_t quads[2] = {};
+        for (auto mode: {ChunkMesher::PER_FACE, ChunkMesher::GREEDY}) {
+            start = Clock::now();
+            for (uint32_t i = 0; i < iterations; i++) {
+                quads[mode] = kernels->generateIsolatedMesh(blocks.data(), {1.0f, 1.0f, 1.0f}, mode).vertices.size() / 4;
+            }
+            meshing[mode] = Clock::now() - start;
+        }
+
+        const float chunkMs = 1000.0f / static_cast<float>(iterations);
+        const float megaBlocks = static_cast<float>(blocks.size()) / 1e6f;
+        CORE_INFO("{}x{}x{} kernels, per chunk: decoding {} ms, per face meshing {} ms ({} quads), greedy meshing {} ms ({} quads), "
+                  "per million blocks: decoding {} ms, per face meshing {} ms, greedy meshing {} ms\n",
+                  kernels->chunkSize, kernels->chunkSize, kernels->chunkDepth,
+                  decoding.count() * chunkMs, meshing[ChunkMesher::PER_FACE].count() * chunkMs, quads[ChunkMesher::PER_FACE],
+                  meshing[ChunkMesher::GREEDY].count() * chunkMs, quads[ChunkMesher::GREEDY],
+                  decoding.count() * chunkMs / megaBlocks, meshing[ChunkMesher::PER_FACE].count() * chunkMs / megaBlocks,
+                  meshing[ChunkMesher::GREEDY].count() * chunkMs / megaBlocks);
+    }
+}
+
+bool ChunkBenchmarks::verifyComputeMesher(VulkanEngine::VulkanComputeMesher &mesher) {
+    using Kernels = ChunkMesher::Kernels;
+    using Clock = std::chrono::steady_clock;
+
+    const std::vector<Block::block_id> blockIds = generateSyntheticChunk(CHUNK_SIZE, CHUNK_DEPTH);
+    std::vector<Block> blocks(Kernels::VOLUME);
+    Kernels::decodeBlocks(blockIds.data(), blocks.data());
+
+    // Solid neighbors on two sides cover both apron paths of the shader, the other two sides keep their border faces
+    ChunkMesher::ChunkApron apron{};
+    for (uint32_t z = 0; z < CHUNK_DEPTH / 4; z++) {
+        apron.left[z] = Kernels::ROW_MASK;
+        apron.front[z] = Kernels::ROW_MASK;
+    }
+    apron.neighbors = APRON_LEFT | APRON_FRONT;
+
+    auto start = Clock::now();
+    const size_t cpuFaces = Kernels::generateFaces(Kernels::BlockArray{blocks.data()}, apron).faces.size();
+    std::chrono::duration<float> cpu = Clock::now() - start;
+
+    // Includes the input upload, the face count readback and the copy into the sized model, without waiting for the copy
+    start = Clock::now();
+    const std::vector<uint32_t> apronRows = ChunkMesher::getApronRows(apron);
+    std::unique_ptr<VulkanEngine::VulkanModel> model = mesher.MeshChunk(blockIds.data(), apronRows.data());
+    std::chrono::duration<float> gpu = Clock::now() - start;
+    const uint32_t gpuFaces = model != nullptr ? mesher.ReadFaceCount(*model) : 0;
+
+    CORE_INFO("Compute mesher check: {} faces on the GPU in {} ms, {} faces on the CPU in {} ms\n", gpuFaces, gpu.count() * 1000, cpuFaces,
+              cpu.count() * 1000);
+    if (gpuFaces != cpuFaces) {
+        CORE_ERROR("Compute mesher found {} faces where the CPU kernels found {}\n", gpuFaces, cpuFaces);
+        return false;
+    }
+    return true;
+}
+
+std::vector<glm::uvec2> ChunkBenchmarks::getPositionsAroundCenter(uint32_t radius) {
+    const glm::ivec2 center = {(MAP_WIDTH / CHUNK_SIZE / 2) * CHUNK_SIZE, (MAP_HEIGHT / CHUNK_SIZE / 2) * CHUNK_SIZE};
+    const int32_t r = static_cast<int32_t>(radius);
+
+    std::vector<glm::uvec2> positions{};
+    for (int32_t x = -r; x <= r; x++) {
+        for (int32_t y = -r; y <= r; y++) {
+            const glm::ivec2 position = center + glm::ivec2{x, y} * CHUNK_SIZE;
+            if (isInsideMapRange(glm::vec2(position))) {
+                positions.emplace_back(position);
+            }
+        }
+    }
+    return positions;
+}
+
+std::vector<Block::block_id> ChunkBenchmarks::generateSyntheticChunk(uint32_t size, uint32_t depth) {
+    // Rolling terrain about a quarter of the depth high with a band of scattered caves below it
+    std::vector<Block::block_id> ids(size * size * depth, Block::BlockTypes::AIR);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            const uint32_t height = std::min(depth, depth / 4 + (x * 7 + y * 13) % 23 + ((x ^ y) & 7u));
+            for (uint32_t z = 0; z < height; z++) {
+                const bool cave = z > 8 && z < 24 && (x * 3 + y * 5 + z * 7) % 11 == 0;
+                if (!cave) ids[x + y * size + z * size * size] = Block::BlockTypes::SOLID;
+            }
+        }
+    }
+    return ids;
+}
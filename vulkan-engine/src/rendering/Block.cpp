@@ -1,191 +1,157 @@
 #include "../../include/rendering/Block.h"
 
-VulkanEngineModel::Builder Block::getFaceVertices(glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, glm::vec3 color) {
-    VulkanEngineModel::Builder builder = VulkanEngineModel::Builder{};
+void Block::getFaceCorners(glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, glm::vec3 (&corners)[4], glm::vec2 (&uvs)[4], glm::vec3 &normal) {
+    glm::vec3 quad[4];
+    bool reversed = false;
 
     if (orientation == TOP || orientation == BOTTOM) {
-        int normal;
-        if (orientation == TOP) {
-            builder.indices = {0, 2, 1, 2, 0, 3};
-            normal = -1.0f;
-        } else {
-            builder.indices = {0, 1, 2, 2, 3, 0};
-            normal = 1.0f;
-        }
-
-        auto vert1 = VulkanEngineModel::Vertex{};
-        vert1.position = {pos.x, pos.y, pos.z};
-        vert1.color = color;
-        vert1.uv = {0.0f, 0.0f};
-        vert1.normal = {0.0f, normal, 0.0f};
-
-        auto vert2 = VulkanEngineModel::Vertex{};
-        vert2.position = {pos.x, pos.y, pos.z + size.z};
-        vert2.color = color;
-        vert2.uv = {1.0f, 0.0f};
-        vert2.normal = {0.0f, normal, 0.0f};
-
-        auto vert3 = VulkanEngineModel::Vertex{};
-        vert3.position = {pos.x + size.x, pos.y, pos.z + size.z};
-        vert3.color = color;
-        vert3.uv = {1.0f, 1.0f};
-        vert3.normal = {0.0f, normal, 0.0f};
-
-        auto vert4 = VulkanEngineModel::Vertex{};
-        vert4.position = {pos.x + size.x, pos.y, pos.z};
-        vert4.color = color;
-        vert4.uv = {0.0f, 1.0f};
-        vert4.normal = {0.0f, normal, 0.0f};
-
-        builder.vertices = {vert1, vert2, vert3, vert4};
+        reversed = orientation == TOP;
+        normal = {0.0f, orientation == TOP ? -1.0f : 1.0f, 0.0f};
+
+        quad[0] = {pos.x, pos.y, pos.z};
+        quad[1] = {pos.x, pos.y, pos.z + size.z};
+        quad[2] = {pos.x + size.x, pos.y, pos.z + size.z};
+        quad[3] = {pos.x + size.x, pos.y, pos.z};
     } else if (orientation == LEFT || orientation == RIGHT) {
-        int normal;
-        if (orientation == RIGHT) {
-            builder.indices = {0, 2, 1, 2, 0, 3};
-            normal = -1.0f;
-        } else {
-            builder.indices = {0, 1, 2, 2, 3, 0};
-            normal = 1.0f;
-        }
-
-        auto vert1 = VulkanEngineModel::Vertex{};
-        vert1.position = {pos.x, pos.y + size.y, pos.z};
-        vert1.color = color;
-        vert1.uv = {0.0f, 0.0f};
-        vert1.normal = {0.0f, 0.0f, normal};
-
-        auto vert2 = VulkanEngineModel::Vertex{};
-        vert2.position = {pos.x, pos.y, pos.z};
-        vert2.color = color;
-        vert2.uv = {1.0f, 0.0f};
-        vert2.normal = {0.0f, 0.0f, normal};
-
-        auto vert3 = VulkanEngineModel::Vertex{};
-        vert3.position = {pos.x + size.x, pos.y, pos.z};
-        vert3.color = color;
-        vert3.uv = {1.0f, 1.0f};
-        vert3.normal = {0.0f, 0.0f, normal};
-
-        auto vert4 = VulkanEngineModel::Vertex{};
-        vert4.position = {pos.x + size.x, pos.y + size.y, pos.z};
-        vert4.color = color;
-        vert4.uv = {0.0f, 1.0f};
-        vert4.normal = {0.0f, 0.0f, normal};
-
-        builder.vertices = {vert1, vert2, vert3, vert4};
-    } else if (orientation == FRONT || orientation == BACK) {
-        int normal;
-        if (orientation == BACK) {
-            builder.indices = {0, 1, 2, 2, 3, 0};
-            normal = -1.0f;
-        } else {
-            builder.indices = {0, 2, 1, 2, 0, 3};
-            normal = 1.0f;
-        }
-
-        auto vert1 = VulkanEngineModel::Vertex{};
-        vert1.position = {pos.x, pos.y + size.y, pos.z};
-        vert1.color = color;
-        vert1.uv = {0.0f, 0.0f};
-        vert1.normal = {0.0f, 0.0f, normal};
-
-        auto vert2 = VulkanEngineModel::Vertex{};
-        vert2.position = {pos.x, pos.y, pos.z};
-        vert2.color = color;
-        vert2.uv = {1.0f, 0.0f};
-        vert2.normal = {0.0f, 0.0f, normal};
-
-        auto vert3 = VulkanEngineModel::Vertex{};
-        vert3.position = {pos.x, pos.y, pos.z + size.z};
-        vert3.color = color;
-        vert3.uv = {1.0f, 1.0f};
-        vert3.normal = {0.0f, 0.0f, normal};
-
-        auto vert4 = VulkanEngineModel::Vertex{};
-        vert4.position = {pos.x, pos.y + size.y, pos.z + size.z};
-        vert4.color = color;
-        vert4.uv = {0.0f, 1.0f};
-        vert4.normal = {0.0f, 0.0f, normal};
-
-        builder.vertices = {vert1, vert2, vert3, vert4};
+        reversed = orientation == RIGHT;
+        normal = {0.0f, 0.0f, orientation == RIGHT ? -1.0f : 1.0f};
+
+        quad[0] = {pos.x, pos.y + size.y, pos.z};
+        quad[1] = {pos.x, pos.y, pos.z};
+        quad[2] = {pos.x + size.x, pos.y, pos.z};
+        quad[3] = {pos.x + size.x, pos.y + size.y, pos.z};
+    } else {
+        reversed = orientation == FRONT;
+        normal = {0.0f, 0.0f, orientation == BACK ? -1.0f : 1.0f};
+
+        quad[0] = {pos.x, pos.y + size.y, pos.z};
+        quad[1] = {pos.x, pos.y, pos.z};
+        quad[2] = {pos.x, pos.y, pos.z + size.z};
+        quad[3] = {pos.x, pos.y + size.y, pos.z + size.z};
     }
 
-    return builder;
+    static const glm::vec2 quadUvs[4] = {{0.0f, 0.0f},
+                                         {1.0f, 0.0f},
+                                         {1.0f, 1.0f},
+                                         {0.0f, 1.0f}};
+
+    // Every face follows the 0, 1, 2, 2, 3, 0 quad pattern so chunk models can be drawn with the shared quad index buffer,
+    // faces wound the other way list their vertices in reverse order instead
+    static const uint32_t order[4] = {0, 1, 2, 3};
+    static const uint32_t reversedOrder[4] = {0, 3, 2, 1};
+    const uint32_t *vertexOrder = reversed ? reversedOrder : order;
+
+    for (int i = 0; i < 4; i++) {
+        corners[i] = quad[vertexOrder[i]];
+        uvs[i] = quadUvs[vertexOrder[i]];
+    }
 }
 
+void Block::emitFace(FaceSpans &out, glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, glm::vec3 color) {
+    assert(out.faceCount < out.faceCapacity && "Face spans are full, was the capacity estimated from the exposed face count?");
+
+    glm::vec3 corners[4];
+    glm::vec2 uvs[4];
+    glm::vec3 normal;
+    getFaceCorners(pos, orientation, size, corners, uvs, normal);
+
+    const uint32_t baseVertex = out.faceCount * 4;
+    VulkanEngine::VulkanModel::Vertex *vertices = out.vertices + baseVertex;
+    for (int i = 0; i < 4; i++) {
+        VulkanEngine::VulkanModel::Vertex &vertex = vertices[i];
+        vertex.position = corners[i];
+        vertex.color = color;
+        vertex.normal = normal;
+        vertex.uv = uvs[i];
+    }
+
+    if (out.indices != nullptr) {
+        uint32_t *indices = out.indices + out.faceCount * 6;
+        indices[0] = baseVertex;
+        indices[1] = baseVertex + 1;
+        indices[2] = baseVertex + 2;
+        indices[3] = baseVertex + 2;
+        indices[4] = baseVertex + 3;
+        indices[5] = baseVertex;
+    }
 
-VulkanEngineModel::Builder Block::getCubeFaces(glm::vec3 world_pos, glm::vec3 size, glm::vec3 color, bool left, bool right, bool top, bool bottom, bool front, bool back) {
-    VulkanEngineModel::Builder cubeFaces;
+    out.faceCount++;
+}
+
+void Block::emitFace(TerrainFaceSpans &out, glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, uint32_t colorIndex) {
+    assert(out.faceCount < out.faceCapacity && "Face spans are full, was the capacity estimated from the exposed face count?");
+
+    glm::vec3 corners[4];
+    glm::vec2 uvs[4];
+    glm::vec3 normal;
+    getFaceCorners(pos, orientation, size, corners, uvs, normal);
+
+    // Packed positions are in world coordinates, shaders/terrain.vert maps them back to camera space and looks up the normal
+    VulkanEngine::VulkanModel::TerrainVertex *vertices = out.vertices + out.faceCount * 4;
+    for (int i = 0; i < 4; i++) {
+        vertices[i] = VulkanEngine::VulkanModel::TerrainVertex::Pack(glm::uvec3(fromCameraToWorld(corners[i])), orientation, colorIndex);
+    }
+
+    out.faceCount++;
+}
+
+template<typename Spans, typename Color>
+static void emitCubeFacesTo(Spans &out, glm::vec3 world_pos, glm::vec3 size, Color color, bool left, bool right, bool top, bool bottom, bool front,
+                            bool back) {
+    const glm::vec3 cameraSize = fromWorldToCamera(size);
 
-    int i = 0;
     if (left) {
-        VulkanEngineModel::Builder vertices = getFaceVertices(fromWorldToCamera({world_pos.x, world_pos.y, world_pos.z}),
-                                                              FaceOrientation::LEFT, fromWorldToCamera(size), color);
-        for (auto vertex: vertices.vertices) {
-            cubeFaces.vertices.emplace_back(vertex);
-        }
-        for (auto index: vertices.indices) {
-            cubeFaces.indices.emplace_back(index + i);
-        }
-
-        i += 4;
+        Block::emitFace(out, fromWorldToCamera({world_pos.x, world_pos.y, world_pos.z}), Block::FaceOrientation::LEFT, cameraSize, color);
     }
     if (right) {
-        VulkanEngineModel::Builder vertices = getFaceVertices(fromWorldToCamera({world_pos.x + size.x, world_pos.y, world_pos.z}),
-                                                              FaceOrientation::RIGHT, fromWorldToCamera(size), color);
-        for (auto vertex: vertices.vertices) {
-            cubeFaces.vertices.emplace_back(vertex);
-        }
-        for (auto index: vertices.indices) {
-            cubeFaces.indices.emplace_back(index + i);
-        }
-        i += 4;
+        Block::emitFace(out, fromWorldToCamera({world_pos.x + size.x, world_pos.y, world_pos.z}), Block::FaceOrientation::RIGHT, cameraSize, color);
     }
 
     if (top) {
-        VulkanEngineModel::Builder vertices = getFaceVertices(fromWorldToCamera({world_pos.x, world_pos.y, world_pos.z + size.z}),
-                                                              FaceOrientation::TOP, fromWorldToCamera(size), color);
-        for (auto vertex: vertices.vertices) {
-            cubeFaces.vertices.emplace_back(vertex);
-        }
-        for (auto index: vertices.indices) {
-            cubeFaces.indices.emplace_back(index + i);
-        }
-        i += 4;
+        Block::emitFace(out, fromWorldToCamera({world_pos.x, world_pos.y, world_pos.z + size.z}), Block::FaceOrientation::TOP, cameraSize, color);
     }
     if (bottom) {
-        VulkanEngineModel::Builder vertices = getFaceVertices(fromWorldToCamera({world_pos.x, world_pos.y, world_pos.z}),
-                                                              FaceOrientation::BOTTOM, fromWorldToCamera(size), color);
-        for (auto vertex: vertices.vertices) {
-            cubeFaces.vertices.emplace_back(vertex);
-        }
-        for (auto index: vertices.indices) {
-            cubeFaces.indices.emplace_back(index + i);
-        }
-        i += 4;
+        Block::emitFace(out, fromWorldToCamera({world_pos.x, world_pos.y, world_pos.z}), Block::FaceOrientation::BOTTOM, cameraSize, color);
     }
 
     if (front) {
-        VulkanEngineModel::Builder vertices = getFaceVertices(fromWorldToCamera({world_pos.x, world_pos.y, world_pos.z}),
-                                                              FaceOrientation::FRONT, fromWorldToCamera(size), color);
-        for (auto vertex: vertices.vertices) {
-            cubeFaces.vertices.emplace_back(vertex);
-        }
-        for (auto index: vertices.indices) {
-            cubeFaces.indices.emplace_back(index + i);
-        }
-        i += 4;
+        Block::emitFace(out, fromWorldToCamera({world_pos.x, world_pos.y, world_pos.z}), Block::FaceOrientation::FRONT, cameraSize, color);
     }
     if (back) {
-        VulkanEngineModel::Builder vertices = getFaceVertices(fromWorldToCamera({world_pos.x, world_pos.y + size.y, world_pos.z}),
-                                                              FaceOrientation::BACK, fromWorldToCamera(size), color);
-        for (auto vertex: vertices.vertices) {
-            cubeFaces.vertices.emplace_back(vertex);
-        }
-        for (auto index: vertices.indices) {
-            cubeFaces.indices.emplace_back(index + i);
-        }
+        Block::emitFace(out, fromWorldToCamera({world_pos.x, world_pos.y + size.y, world_pos.z}), Block::FaceOrientation::BACK, cameraSize, color);
     }
+}
+
+void Block::emitCubeFaces(FaceSpans &out, glm::vec3 world_pos, glm::vec3 size, glm::vec3 color, bool left, bool right, bool top, bool bottom, bool front,
+                          bool back) {
+    emitCubeFacesTo(out, world_pos, size, color, left, right, top, bottom, front, back);
+}
+
+void Block::emitCubeFaces(TerrainFaceSpans &out, glm::vec3 world_pos, glm::vec3 size, uint32_t colorIndex, bool left, bool right, bool top, bool bottom,
+                          bool front, bool back) {
+    emitCubeFacesTo(out, world_pos, size, colorIndex, left, right, top, bottom, front, back);
+}
+
+VulkanEngine::VulkanModel::Builder Block::getFaceVertices(glm::vec3 pos, FaceOrientation orientation, glm::vec3 size, glm::vec3 color) {
+    VulkanEngine::VulkanModel::Builder builder = VulkanEngine::VulkanModel::Builder{};
+    builder.vertices.resize(4);
+    builder.indices.resize(6);
 
+    FaceSpans spans{builder.vertices.data(), builder.indices.data(), 1};
+    emitFace(spans, pos, orientation, size, color);
+
+    return builder;
+}
+
+VulkanEngine::VulkanModel::Builder Block::getCubeFaces(glm::vec3 world_pos, glm::vec3 size, glm::vec3 color, bool left, bool right, bool top, bool bottom, bool front, bool back) {
+    VulkanEngine::VulkanModel::Builder cubeFaces;
+    cubeFaces.vertices.resize(6 * 4);
+    cubeFaces.indices.resize(6 * 6);
+
+    FaceSpans spans{cubeFaces.vertices.data(), cubeFaces.indices.data(), 6};
+    emitCubeFaces(spans, world_pos, size, color, left, right, top, bottom, front, back);
+
+    cubeFaces.vertices.resize(spans.faceCount * 4);
+    cubeFaces.indices.resize(spans.faceCount * 6);
     return cubeFaces;
-}
\ No newline at end of file
+}
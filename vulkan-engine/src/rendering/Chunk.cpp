@@ -1,12 +1,12 @@
 #include "../../include/rendering/Chunk.h"
 
-GameObject Chunk::getChunkBorders(VulkanEngineDevice &_device, const Chunk &chunk) {
-    VulkanEngineModel::Builder bordersBuilder{};
+VulkanEngine::VulkanGameObject Chunk::getChunkBorders(VulkanEngine::VulkanDevice &_device, const Chunk &chunk) {
+    VulkanEngine::VulkanModel::Builder bordersBuilder{};
 
     glm::vec3 size = {CHUNK_SIZE, CHUNK_SIZE, CHUNK_DEPTH};
     glm::vec3 pos = {chunk._position, 0};
 
-    VulkanEngineModel::Builder faces = Block::getCubeFaces(pos, size, {1.f, 1.f, 0.f}, true, true, false, false, true, true);
+    VulkanEngine::VulkanModel::Builder faces = Block::getCubeFaces(pos, size, {1.f, 1.f, 0.f}, true, true, false, false, true, true);
 
     for (auto vertex: faces.vertices) {
         bordersBuilder.vertices.emplace_back(vertex);
@@ -15,12 +15,46 @@ GameObject Chunk::getChunkBorders(VulkanEngineDevice &_device, const Chunk &chun
         bordersBuilder.indices.emplace_back(index);
     }
 
-    GameObject obj = GameObject::createGameObject(fmt::format("{}-border", chunk._gameObjectId));
-    obj.model = std::make_unique<VulkanEngineModel>(_device, bordersBuilder);
+    VulkanEngine::VulkanGameObject obj = VulkanEngine::VulkanGameObject::CreateGameObject(chunk._id | BORDER_KEY_FLAG);
+    obj.model = std::make_shared<VulkanEngine::VulkanModel>(_device, bordersBuilder);
     obj.color = glm::vec3(1.0f, 0.0f, 0.0f);
     obj.transform.translation = {0.0f, 0.0f, 0.0f};
-    obj.renderMode = GameObject::RENDER_MODE_WIREFRAME;
+    obj.renderMode = VulkanEngine::VulkanGameObject::RENDER_MODE_WIREFRAME;
     obj.isActive = false;
 
     return obj;
 }
+
+std::vector<std::shared_ptr<VulkanEngine::VulkanModel>> Chunk::acquireModels(VulkanEngine::VulkanDevice &device, ChunkModelCache &modelCache,
+                                                                             std::vector<ChunkPrefab> &prefabs) {
+    std::vector<std::shared_ptr<VulkanEngine::VulkanModel>> models(prefabs.size());
+    std::vector<ChunkModelCache::GpuMeshRequest> gpuRequests{};
+    std::vector<size_t> gpuPrefabs{};
+
+    for (size_t i = 0; i < prefabs.size(); i++) {
+        ChunkPrefab &prefab = prefabs[i];
+        if (prefab.cachedModel != nullptr) {
+            models[i] = prefab.cachedModel;
+        } else if (!prefab.blockIds.empty()) {
+            gpuRequests.push_back({prefab.contentHash, std::move(prefab.contentKey), prefab.blockIds.data(), prefab.apronRows.data()});
+            gpuPrefabs.push_back(i);
+        } else if (prefab.getFaceCount() == 0) {
+            models[i] = nullptr;
+        } else if (CHUNK_VERTEX_PULLING) {
+            models[i] = modelCache.getOrCreate(device, prefab.contentHash, std::move(prefab.contentKey), prefab.faceBuilder);
+        } else if (CHUNK_VERTICES_PACKED) {
+            models[i] = modelCache.getOrCreate(device, prefab.contentHash, std::move(prefab.contentKey), prefab.terrainBuilder);
+        } else {
+            models[i] = modelCache.getOrCreate(device, prefab.contentHash, std::move(prefab.contentKey), prefab.builder);
+        }
+    }
+
+    if (!gpuRequests.empty()) {
+        std::vector<std::shared_ptr<VulkanEngine::VulkanModel>> gpuModels = modelCache.getOrCreate(std::move(gpuRequests));
+        for (size_t k = 0; k < gpuPrefabs.size(); k++) {
+            models[gpuPrefabs[k]] = std::move(gpuModels[k]);
+        }
+    }
+
+    return models;
+}
@@ -0,0 +1,276 @@
+#include "../../include/rendering/ChunkBlockStorage.h"
+#include "../../include/rendering/ChunkEncoding.h"
+
+#include <algorithm>
+
+ChunkBlockStorage::ChunkBlockStorage(const ChunkBlockStorage &other) {
+    *this = other;
+}
+
+ChunkBlockStorage &ChunkBlockStorage::operator=(const ChunkBlockStorage &other) {
+    if (this == &other) return *this;
+
+    palette = other.palette;
+    layout = other.layout;
+    bitsPerBlock = other.bitsPerBlock;
+    solidIndex = other.solidIndex;
+    for (uint32_t s = 0; s < SECTION_COUNT; s++) {
+        const Section &source = other.sections[s];
+        Section &section = sections[s];
+        section.uniformIndex = source.uniformIndex;
+        if (source.uniformIndex != NOT_UNIFORM) {
+            section.words.reset();
+            continue;
+        }
+
+        if (section.words.size() != source.words.size()) section.words = acquireWords(bitsPerBlock);
+        std::copy_n(source.words.data(), source.words.size(), section.words.data());
+    }
+    return *this;
+}
+
+void ChunkBlockStorage::setBlockId(uint32_t serial, Block::block_id id) {
+    const uint32_t index = findOrAddIndex(id);
+    const uint32_t bits = getBitsFor(palette.size());
+    if (bits > bitsPerBlock) {
+        // Repacking walks every packed block, it only happens when a chunk gets a block type for the first time
+        for (uint32_t s = 0; s < SECTION_COUNT; s++) {
+            Section &section = sections[s];
+            if (section.uniformIndex != NOT_UNIFORM) continue;
+
+            ChunkSectionPool::Handle packed = acquireWords(bits);
+            std::fill_n(packed.data(), packed.size(), 0);
+            for (uint32_t position = 0; position < SECTION_VOLUME; position++) {
+                const uint32_t bit = position * bits;
+                packed[bit / WORD_BITS] |= Word{readIndex(section, position)} << (bit % WORD_BITS);
+            }
+            section.words = std::move(packed);
+        }
+        bitsPerBlock = bits;
+    }
+    fillIndices(serial, 1, index);
+}
+
+void ChunkBlockStorage::fill(Block::block_id id) {
+    palette = {id};
+    reset(1);
+}
+
+void ChunkBlockStorage::assign(const Block::block_id *ids) {
+    palette.clear();
+    bool seen[256] = {};
+    for (uint32_t i = 0; i < VOLUME; i++) {
+        if (seen[ids[i]]) continue;
+        seen[ids[i]] = true;
+        palette.push_back(ids[i]);
+    }
+
+    reset(getBitsFor(palette.size()));
+    uint32_t i = 0;
+    while (i < VOLUME) {
+        uint32_t run = 1;
+        while (i + run < VOLUME && ids[i + run] == ids[i]) {
+            run++;
+        }
+        fillIndices(i, run, findOrAddIndex(ids[i]));
+        i += run;
+    }
+    compact();
+}
+
+bool ChunkBlockStorage::assignEncoded(const unsigned char *data, size_t size) {
+    // The first pass validates the payload and collects the palette, so the indices are packed at their final width once
+    std::vector<Block::block_id> runPalette{};
+    bool seen[256] = {};
+    const bool valid = ChunkEncoding::forEachRunAnyFormat(data, size, VOLUME, [&](size_t, size_t length, unsigned char id) {
+        if (length == 0 || seen[id]) return;
+        seen[id] = true;
+        runPalette.push_back(id);
+    });
+    if (!valid) return false;
+
+    palette = std::move(runPalette);
+    reset(getBitsFor(palette.size()));
+    ChunkEncoding::forEachRunAnyFormat(data, size, VOLUME, [this](size_t first, size_t length, unsigned char id) {
+        if (length == 0) return;
+        fillIndices(static_cast<uint32_t>(first), static_cast<uint32_t>(length), findOrAddIndex(id));
+    });
+    compact();
+    return true;
+}
+
+void ChunkBlockStorage::copyTo(Block::block_id *ids) const {
+    for (uint32_t i = 0; i < VOLUME; i++) {
+        ids[i] = getBlockId(i);
+    }
+}
+
+ChunkBlockStorage::Word ChunkBlockStorage::getSolidRow(uint32_t y, uint32_t z) const {
+    constexpr Word rowMask = CHUNK_SIZE == WORD_BITS ? ~Word{0} : (Word{1} << CHUNK_SIZE) - 1;
+    if (solidIndex == NO_INDEX) return 0;
+
+    const Section &section = sections[z / SECTION_HEIGHT];
+    if (section.uniformIndex != NOT_UNIFORM) return section.uniformIndex == solidIndex ? rowMask : 0;
+
+    if (layout == MORTON) {
+        const uint32_t base = MORTON_Y[y] | MORTON_Z[z % SECTION_HEIGHT];
+        Word row = 0;
+        for (uint32_t x = 0; x < CHUNK_SIZE; x++) {
+            row |= Word{readIndex(section, base | MORTON_X[x]) == solidIndex} << x;
+        }
+        return row;
+    }
+
+    const uint32_t first = (y + (z % SECTION_HEIGHT) * CHUNK_SIZE) * CHUNK_SIZE;
+    if (bitsPerBlock == 1) {
+        const Word row = (section.words[first / WORD_BITS] >> (first % WORD_BITS)) & rowMask;
+        return solidIndex == 1 ? row : ~row & rowMask;
+    }
+
+    Word row = 0;
+    for (uint32_t x = 0; x < CHUNK_SIZE; x++) {
+        row |= Word{readIndex(section, first + x) == solidIndex} << x;
+    }
+    return row;
+}
+
+bool ChunkBlockStorage::getUniformLayer(uint32_t z, Block::block_id &id) const {
+    const Section &section = sections[z / SECTION_HEIGHT];
+    if (section.uniformIndex == NOT_UNIFORM) return false;
+
+    id = palette[section.uniformIndex];
+    return true;
+}
+
+content_hash ChunkBlockStorage::hash() const {
+    content_hash hash = hashBytes(&layout, sizeof(layout));
+    hash = hashBytes(palette.data(), palette.size(), hash);
+    for (const auto &section: sections) {
+        hash = hashBytes(&section.uniformIndex, sizeof(section.uniformIndex), hash);
+        if (section.words) hash = hashBytes(section.words.data(), section.words.size() * sizeof(Word), hash);
+    }
+    return hash;
+}
+
+void ChunkBlockStorage::appendContent(content_key &key) const {
+    auto append = [&key](const void *data, size_t size) {
+        const auto *bytes = static_cast<const unsigned char *>(data);
+        key.insert(key.end(), bytes, bytes + size);
+    };
+
+    append(&layout, sizeof(layout));
+    append(palette.data(), palette.size());
+    for (const auto &section: sections) {
+        append(&section.uniformIndex, sizeof(section.uniformIndex));
+        if (section.words) append(section.words.data(), section.words.size() * sizeof(Word));
+    }
+}
+
+size_t ChunkBlockStorage::getMemoryUsage() const {
+    size_t bytes = palette.size() + sizeof(sections);
+    for (const auto &section: sections) {
+        bytes += section.words.size() * sizeof(Word);
+    }
+    return bytes;
+}
+
+void ChunkBlockStorage::reset(uint32_t bits) {
+    bitsPerBlock = bits;
+    for (auto &section: sections) {
+        section.uniformIndex = 0;
+        section.words.reset();
+    }
+    updateSolidIndex();
+}
+
+ChunkSectionPool::Handle ChunkBlockStorage::acquireWords(uint32_t bits) const {
+    return ChunkSectionPool::getInstance().acquire(SECTION_VOLUME * bits / WORD_BITS);
+}
+
+void ChunkBlockStorage::fillIndices(uint32_t first, uint32_t count, uint32_t index) {
+    const uint32_t end = first + count;
+    while (first < end) {
+        Section &section = sections[first / SECTION_VOLUME];
+        const uint32_t offset = first % SECTION_VOLUME;
+        const uint32_t span = std::min(SECTION_VOLUME - offset, end - first);
+        first += span;
+
+        if (span == SECTION_VOLUME) {
+            section.uniformIndex = index;
+            section.words.reset();
+            continue;
+        }
+        if (section.uniformIndex == index) continue;
+
+        if (section.uniformIndex != NOT_UNIFORM) {
+            section.words = acquireWords(bitsPerBlock);
+            std::fill_n(section.words.data(), section.words.size(), getPattern(section.uniformIndex));
+            section.uniformIndex = NOT_UNIFORM;
+        }
+        if (layout == LINEAR) {
+            fillSectionWords(section, offset, span, index);
+            continue;
+        }
+        // A run is scattered over the Morton positions, its blocks are written one by one
+        for (uint32_t local = offset; local < offset + span; local++) {
+            writeIndex(section, getPosition(local), index);
+        }
+    }
+}
+
+void ChunkBlockStorage::fillSectionWords(Section &section, uint32_t first, uint32_t count, uint32_t index) const {
+    // Runs are written a word at a time
+    const Word pattern = getPattern(index);
+    uint64_t bit = uint64_t{first} * bitsPerBlock;
+    const uint64_t end = (uint64_t{first} + count) * bitsPerBlock;
+    while (bit < end) {
+        const uint32_t offset = bit % WORD_BITS;
+        const uint32_t span = static_cast<uint32_t>(std::min<uint64_t>(WORD_BITS - offset, end - bit));
+        const Word mask = (span == WORD_BITS ? ~Word{0} : (Word{1} << span) - 1) << offset;
+
+        Word &word = section.words[bit / WORD_BITS];
+        word = (word & ~mask) | (pattern & mask);
+        bit += span;
+    }
+}
+
+void ChunkBlockStorage::compact() {
+    for (auto &section: sections) {
+        if (section.uniformIndex != NOT_UNIFORM) continue;
+
+        const uint32_t index = static_cast<uint32_t>(section.words[0]) & ((1u << bitsPerBlock) - 1);
+        const Word pattern = getPattern(index);
+        const Word *words = section.words.data();
+        if (std::all_of(words, words + section.words.size(), [pattern](Word word) { return word == pattern; })) {
+            section.uniformIndex = index;
+            section.words.reset();
+        }
+    }
+}
+
+uint32_t ChunkBlockStorage::findOrAddIndex(Block::block_id id) {
+    const auto it = std::find(palette.begin(), palette.end(), id);
+    if (it != palette.end()) return static_cast<uint32_t>(it - palette.begin());
+
+    palette.push_back(id);
+    updateSolidIndex();
+    return static_cast<uint32_t>(palette.size() - 1);
+}
+
+void ChunkBlockStorage::updateSolidIndex() {
+    const auto it = std::find(palette.begin(), palette.end(), Block::BlockTypes::SOLID);
+    solidIndex = it != palette.end() ? static_cast<uint16_t>(it - palette.begin()) : NO_INDEX;
+}
+
+ChunkBlockStorage::Word ChunkBlockStorage::getPattern(uint32_t index) const {
+    // All ones divided by the index mask has a one at the bottom of every index slot, e.g. 0x0101...01 for 8 bits
+    return Word{index} * (~Word{0} / ((Word{1} << bitsPerBlock) - 1));
+}
+
+uint32_t ChunkBlockStorage::getBitsFor(size_t paletteSize) {
+    uint32_t bits = 1;
+    while ((size_t{1} << bits) < paletteSize) {
+        bits *= 2;
+    }
+    return bits;
+}
@@ -1,5 +1,7 @@
 #include "../../include/rendering/ChunkDeserializer.h"
 
+#include <sqlite3.h>
+
 ChunkDeserializer::RawChunkData ChunkDeserializer::deserializeChunkFromFile(glm::uvec2 chunk_pos) {
     std::ifstream infile(fmt::format("assets/map/{}_{}_level.txt", chunk_pos.x, chunk_pos.y));
 
@@ -33,35 +35,161 @@ ChunkDeserializer::RawChunkData ChunkDeserializer::deserializeChunkFromFile(glm:
     return chunkData;
 }
 
-std::string ChunkDeserializer::readSerialChunkFromFile(glm::uvec2 chunk_pos) {
-    std::ifstream infile(fmt::format("assets/map/{}_{}_level.txt", chunk_pos.x, chunk_pos.y));
+ChunkDeserializer::RawChunkData ChunkDeserializer::deserializeChunkFromDb(glm::uvec2 chunk_pos) {
+    std::string id = fmt::format("{}_{}", chunk_pos.x, chunk_pos.y);
 
-    std::string line;
-    std::string buff;
+    WorkerConnection &connection = acquireConnection();
+    SQLite::Statement &query = connection.selectChunk;
+    // A previous call may have thrown before resetting the statement
+    query.reset();
+    connection.bindChunkPosition(chunk_pos);
 
-    while (std::getline(infile, line)) {
-        std::istringstream iss(line);
+    RawChunkData chunkData{};
+    while (query.executeStep()) {
+        chunkData = decodeChunkColumn(query.getColumn(0), id);
+    }
+    // Ends the implicit read transaction held by the stepped statement
+    query.reset();
 
-        for (char ch: line) {
-            buff.push_back(ch);
-        }
+    return chunkData;
+}
+
+ChunkDeserializer::ChunkPayload ChunkDeserializer::readChunkPayload(glm::uvec2 chunk_pos) {
+    WorkerConnection &connection = acquireConnection();
+    SQLite::Statement &query = connection.selectChunk;
+    query.reset();
+    connection.bindChunkPosition(chunk_pos);
+
+    ChunkPayload payload{};
+    while (query.executeStep()) {
+        payload = copyChunkColumn(query.getColumn(0));
     }
-    infile.close();
-    return buff;
+    query.reset();
+
+    return payload;
 }
 
-ChunkDeserializer::RawChunkData ChunkDeserializer::deserializeChunkFromDb(glm::uvec2 chunk_pos) {
-    RawChunkData chunkData{};
+std::vector<ChunkDeserializer::ChunkPayload> ChunkDeserializer::readChunkPayloads(const std::vector<glm::uvec2> &positions) {
+    WorkerConnection &connection = acquireConnection();
+    if (!connection.selectChunkRange || positions.empty()) {
+        return ChunkStore::readChunkPayloads(positions);
+    }
 
-    std::string id = fmt::format("{}_{}", chunk_pos.x, chunk_pos.y);
+    // Query the bounding rectangle and keep the requested rows only
+    glm::uvec2 min = positions.front();
+    glm::uvec2 max = positions.front();
+    std::unordered_map<uint64_t, size_t> requested{};
+    for (size_t i = 0; i < positions.size(); i++) {
+        min = glm::min(min, positions[i]);
+        max = glm::max(max, positions[i]);
+        requested[packChunkPosition(positions[i])] = i;
+    }
 
-    SQLite::Statement query(db, "SELECT serialized FROM chunks WHERE id = ?");
-    query.bind(1, id);
+    SQLite::Statement &query = *connection.selectChunkRange;
+    query.reset();
+    query.bind(1, min.x);
+    query.bind(2, max.x);
+    query.bind(3, min.y);
+    query.bind(4, max.y);
 
-    std::string serialized;
+    std::vector<ChunkPayload> payloads(positions.size());
     while (query.executeStep()) {
-        serialized = query.getColumn(0).getString();
+        const uint32_t x = query.getColumn(0).getUInt();
+        const uint32_t y = query.getColumn(1).getUInt();
+        auto it = requested.find(packChunkPosition({x, y}));
+        if (it == requested.end()) continue;
+
+        payloads[it->second] = copyChunkColumn(query.getColumn(2));
+    }
+    query.reset();
+
+    return payloads;
+}
+
+bool ChunkDeserializer::loadSummaries(ChunkSummaryIndex &index) {
+    SQLite::Database &db = acquireConnection().db;
+    if (db.execAndGet("SELECT COUNT(*) FROM pragma_table_info('chunk_index') WHERE name = 'solid_count'").getInt() == 0) return false;
+
+    SQLite::Statement query(db, "SELECT x, y, min_height, max_height, solid_count, uniform_block FROM chunk_index");
+    uint32_t loaded = 0;
+    while (query.executeStep()) {
+        ChunkSummary summary{};
+        summary.minSolidHeight = static_cast<uint16_t>(query.getColumn(2).getUInt());
+        summary.maxSolidHeight = static_cast<uint16_t>(query.getColumn(3).getUInt());
+        summary.solidCount = query.getColumn(4).getUInt();
+        summary.uniformBlockId = query.getColumn(5).isNull() ? ChunkSummary::NOT_UNIFORM : static_cast<uint16_t>(query.getColumn(5).getUInt());
+
+        index.set({query.getColumn(0).getUInt(), query.getColumn(1).getUInt()}, summary);
+        loaded++;
+    }
+
+    CORE_INFO("Loaded {} chunk summaries\n", loaded);
+    return true;
+}
+
+ChunkDeserializer::ChunkPayload ChunkDeserializer::copyChunkColumn(const SQLite::Column &column) {
+    // getBlob also returns the characters of text columns
+    const auto *data = static_cast<const unsigned char *>(column.getBlob());
+    return {data, data + column.getBytes()};
+}
+
+ChunkDeserializer::RawChunkData ChunkDeserializer::decodeChunkColumn(const SQLite::Column &column, const std::string &id) {
+    // Migrated rows hold the binary encoding, the rest is still run length text
+    if (column.isBlob()) {
+        RawChunkData chunkData = decodeBinaryChunk(static_cast<const unsigned char *>(column.getBlob()), column.getBytes());
+        if (chunkData.empty()) {
+            CORE_ERROR("Chunk {} has a malformed binary encoding\n", id);
+        }
+        return chunkData;
+    }
+    return decodeTextChunk(column.getString());
+}
+
+// A connection never leaves its thread, so SQLite does not need to lock it
+ChunkDeserializer::WorkerConnection::WorkerConnection()
+        : db(DATABASE_PATH, SQLite::OPEN_READONLY | SQLITE_OPEN_NOMUTEX),
+          hasCoordinateColumns(ChunkDeserializer::hasCoordinateColumns(db)),
+          selectChunk(db, hasCoordinateColumns ? "SELECT serialized FROM chunks WHERE x = ? AND y = ?" : "SELECT serialized FROM chunks WHERE id = ?") {
+    if (hasCoordinateColumns) {
+        selectChunkRange = std::make_unique<SQLite::Statement>(
+                db, "SELECT x, y, serialized FROM chunks WHERE x BETWEEN ? AND ? AND y BETWEEN ? AND ?");
+    }
+}
+
+void ChunkDeserializer::WorkerConnection::bindChunkPosition(glm::uvec2 chunk_pos) {
+    if (hasCoordinateColumns) {
+        selectChunk.bind(1, chunk_pos.x);
+        selectChunk.bind(2, chunk_pos.y);
+    } else {
+        // Databases from before WorldBaker only have the text ids
+        selectChunk.bind(1, fmt::format("{}_{}", chunk_pos.x, chunk_pos.y));
     }
+}
+
+bool ChunkDeserializer::hasCoordinateColumns(SQLite::Database &db) {
+    return db.execAndGet("SELECT COUNT(*) FROM pragma_table_info('chunks') WHERE name IN ('x', 'y')").getInt() == 2;
+}
+
+ChunkDeserializer::WorkerConnection &ChunkDeserializer::acquireConnection() {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+
+    std::unique_ptr<WorkerConnection> &connection = connections[std::this_thread::get_id()];
+    if (!connection) {
+        connection = std::make_unique<WorkerConnection>();
+    }
+    return *connection;
+}
+
+ChunkDeserializer::RawChunkData ChunkDeserializer::decodeBinaryChunk(const unsigned char *data, size_t size) {
+    RawChunkData chunkData(CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH);
+    if (!ChunkEncoding::decode(data, size, chunkData.data(), chunkData.size())) {
+        return {};
+    }
+    return chunkData;
+}
+
+ChunkDeserializer::RawChunkData ChunkDeserializer::decodeTextChunk(const std::string &serialized) {
+    RawChunkData chunkData{};
 
     std::string buff;
     uint32_t i = 0;
@@ -89,30 +217,3 @@ ChunkDeserializer::RawChunkData ChunkDeserializer::deserializeChunkFromDb(glm::u
 
     return chunkData;
 }
-
-void ChunkDeserializer::createDatabaseFile() {
-    SQLite::Database _db("assets/map/mars.db3", SQLite::OPEN_READWRITE);
-
-    SQLite::Statement createTable(_db, "");
-
-    SQLite::Transaction transaction(_db);
-    _db.exec("CREATE TABLE chunks (id TEXT PRIMARY KEY, serialized TEXT)");
-    transaction.commit();
-
-    int chunks_y = MAP_WIDTH / CHUNK_SIZE;
-    int chunks_x = MAP_HEIGHT / CHUNK_SIZE;
-
-    for (int j = 0; j < chunks_x; j++) {
-        for (int i = 0; i < chunks_y; i++) {
-            std::string id = fmt::format("{}_{}", j * CHUNK_SIZE, i * CHUNK_SIZE);
-
-            std::string data = readSerialChunkFromFile({j * CHUNK_SIZE, i * CHUNK_SIZE});
-
-            SQLite::Transaction tr(_db);
-            _db.exec(fmt::format("INSERT INTO chunks (id, serialized) VALUES ('{}','{}')", id, data));
-            tr.commit();
-
-        }
-    }
-
-}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "../../include/rendering/ChunkEncoding.h"
+
+#include <cstring>
+
+static const unsigned char MAGIC[3] = {'C', 'H', 'K'};
+
+std::vector<unsigned char> ChunkEncoding::encode(const unsigned char *blocks, size_t blockCount) {
+    std::vector<unsigned char> data{MAGIC[0], MAGIC[1], MAGIC[2], VERSION};
+
+    size_t i = 0;
+    while (i < blockCount) {
+        const unsigned char id = blocks[i];
+        size_t run = 1;
+        while (i + run < blockCount && blocks[i + run] == id) {
+            run++;
+        }
+        i += run;
+
+        // LEB128, 7 bits per byte with the high bit marking a continuation
+        uint64_t length = run;
+        while (length >= 0x80) {
+            data.push_back(static_cast<unsigned char>(length | 0x80));
+            length >>= 7;
+        }
+        data.push_back(static_cast<unsigned char>(length));
+        data.push_back(id);
+    }
+
+    return data;
+}
+
+bool ChunkEncoding::decode(const unsigned char *data, size_t size, unsigned char *blocks, size_t blockCount) {
+    return forEachRun(data, size, blockCount, [blocks](size_t first, size_t length, unsigned char id) {
+        std::memset(blocks + first, id, length);
+    });
+}
+
+bool ChunkEncoding::decodeText(const char *text, size_t size, unsigned char *blocks, size_t blockCount) {
+    return forEachTextRun(text, size, blockCount, [blocks](size_t first, size_t length, unsigned char id) {
+        std::memset(blocks + first, id, length);
+    });
+}
+
+bool ChunkEncoding::decodeAnyFormat(const unsigned char *data, size_t size, unsigned char *blocks, size_t blockCount) {
+    if (isEncoded(data, size)) {
+        return decode(data, size, blocks, blockCount);
+    }
+    return decodeText(reinterpret_cast<const char *>(data), size, blocks, blockCount);
+}
+
+bool ChunkEncoding::isEncoded(const unsigned char *data, size_t size) {
+    return size >= HEADER_SIZE && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0 && data[3] == VERSION;
+}
@@ -62,7 +62,8 @@ void ChunkManager::loadChunksAroundPlayerAsync(glm::vec3 player_pos, uint32_t di
 
     std::vector<Chunk::chunk_id> deleteIds = {};
     for (auto &chunk: _chunks) {
-        if (chunk.second.getChunkState() == CHUNK_STATE_INVALIDATED) {
+        // Pending remesh jobs still reference the chunk
+        if (chunk.second.getChunkState() == CHUNK_STATE_INVALIDATED && (!chunk.second.hasPendingRemesh() || chunk.second.checkIfRemeshReady())) {
             deleteIds.push_back(chunk.second.getChunkId());
         }
     }
@@ -73,111 +74,195 @@ void ChunkManager::loadChunksAroundPlayerAsync(glm::vec3 player_pos, uint32_t di
     // Get the desired chunks asynchronously using thread pool
     pool.pause();
     uint32_t running_jobs = 0;
+    std::vector<glm::uvec2> requested_positions{};
+    // Uniform chunks are filled from their summary, only the others are read from the store
+    std::vector<glm::uvec2> fetched_positions{};
     for (auto ch_pos: chunk_positions) {
-        if (running_jobs >= max_running_jobs) { return; }
+        if (running_jobs >= max_running_jobs) { break; }
         Chunk::chunk_id id = Chunk::getChunkId(ch_pos);
         if (_chunks.find(id) == _chunks.end()) {
             // Only query those that are not already visible and not in requested state
-            _chunks.emplace(id, std::move(Chunk{id, ch_pos}));
+            _chunks.try_emplace(id, id, ch_pos);
 
-            _chunks[id].setChunkPrefabFuture(pool.submit([this](const glm::uvec2 position) { return generateChunkGameObjectPrefab(position); }, ch_pos));
+            const ChunkSummary *summary = summaryIndex.find(ch_pos);
+            if (summary != nullptr && summary->isEmpty()) {
+                // Nothing to read or mesh, the blocks of a new chunk are already air
+                _chunks[id].setEmpty();
+                continue;
+            }
+
+            requested_positions.emplace_back(ch_pos);
+            if (summary == nullptr || !summary->isUniform()) {
+                fetched_positions.emplace_back(ch_pos);
+            }
             running_jobs += 1;
         } else {
             // Reactivate those already existing
             _chunks[id].activate();
         }
     }
+
+    // All fetched chunks are read in one round trip. The pool runs jobs in submission order,
+    // so the fetch is already running when the meshing jobs start waiting for it.
+    std::shared_future<std::vector<ChunkStore::ChunkPayload>> batch{};
+    if (!fetched_positions.empty()) {
+        batch = pool.submit([this](const std::vector<glm::uvec2> &positions) {
+            Timer timer(CHUNK_STORE_REGION ? "readChunkPayloads (region archive)" : "readChunkPayloads (sqlite)");
+            return chunkStore->readChunkPayloads(positions);
+        }, fetched_positions).share();
+    }
+
+    size_t batch_index = 0;
+    for (auto ch_pos: requested_positions) {
+        // Neighbors are read on this thread while no job writes them, the job only gets the copied apron
+        Chunk &chunk = _chunks[Chunk::getChunkId(ch_pos)];
+        ChunkMesher::ChunkApron apron = buildChunkApron(ch_pos);
+        chunk.setApronNeighbors(apron.neighbors);
+
+        const ChunkSummary *summary = summaryIndex.find(ch_pos);
+        if (summary != nullptr && summary->isUniform()) {
+            const auto blockId = static_cast<Block::block_id>(summary->uniformBlockId);
+            chunk.setChunkPrefabFuture(pool.submit([this, &chunk, blockId](ChunkMesher::ChunkApron apron, ChunkMesher::MeshingMode mode) {
+                populateUniformChunk(chunk, blockId);
+                return generateChunkGameObjectPrefab(chunk, apron, mode);
+            }, std::move(apron), meshingMode));
+        } else {
+            chunk.setChunkPrefabFuture(pool.submit([this, &chunk, batch, batch_index](ChunkMesher::ChunkApron apron, ChunkMesher::MeshingMode mode) {
+                populateChunk(chunk, batch.get()[batch_index]);
+                return generateChunkGameObjectPrefab(chunk, apron, mode);
+            }, std::move(apron), meshingMode));
+            batch_index++;
+        }
+    }
+
+    // Remesh visible chunks whose neighbors changed since they were meshed, arrived neighbors let the faces between them get
+    // culled and invalidated ones need their border faces back
+    for (auto &kv: _chunks) {
+        if (running_jobs >= max_running_jobs) { break; }
+        Chunk &chunk = kv.second;
+        if (chunk.getChunkState() != CHUNK_STATE_VISIBLE || chunk.isEmpty() || chunk.hasPendingRemesh()) continue;
+
+        ChunkMesher::ChunkApron apron = buildChunkApron(chunk.getChunkPosition());
+        if (apron.neighbors == chunk.getApronNeighbors()) continue;
+
+        chunk.setApronNeighbors(apron.neighbors);
+        chunk.setChunkRemeshFuture(pool.submit([this, &chunk](ChunkMesher::ChunkApron apron, ChunkMesher::MeshingMode mode) {
+            return meshChunk(chunk, apron, mode);
+        }, std::move(apron), meshingMode));
+        running_jobs += 1;
+    }
     pool.unpause();
 }
 
-VulkanEngineModel::Builder ChunkManager::generateChunkGameObjectPrefab(const glm::uvec2 position) {
-    VulkanEngineModel::Builder terrainBuilder{};
-
-    const Chunk::chunk_id &id = Chunk::getChunkId(position);
-    CORE_TRACE("Chunk {}_{} begins deserializing\n", position.x, position.y);
-
-    ChunkDeserializer::RawChunkData rawData = terrainDeserializer.deserializeChunkFromDb(position);
-    populateChunk(getChunk(id), rawData);
-
-    float r = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-    float g = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-    float b = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
-    glm::vec3 color = {r, g, b};
-
-    long i = 0;
-    for (int z = 0; z < CHUNK_DEPTH; z++) {
-        for (int y = 0; y < CHUNK_SIZE; y++) {
-            for (int x = 0; x < CHUNK_SIZE; x++) {
-                if (getChunk(id).getBlock({x, y, z}).getBlockId() == Block::BlockTypes::SOLID) {
-
-                    bool leftFace = true;
-                    if (x > 0 && getChunk(id).getBlock({x - 1, y, z}).getBlockId() == Block::BlockTypes::SOLID) {
-                        leftFace = false;
-                    }
-
-                    bool rightFace = true;
-                    if (x < CHUNK_SIZE - 1 && getChunk(id).getBlock({x + 1, y, z}).getBlockId() == Block::BlockTypes::SOLID) {
-                        rightFace = false;
-                    }
-
-                    bool topFace = true;
-                    if (z < CHUNK_DEPTH - 1 && getChunk(id).getBlock({x, y, z + 1}).getBlockId() == Block::BlockTypes::SOLID) {
-                        topFace = false;
-                    }
-
-                    bool bottomFace = true;
-                    if (z > 0 && getChunk(id).getBlock({x, y, z - 1}).getBlockId() == Block::BlockTypes::SOLID) {
-                        bottomFace = false;
-                    }
-
-                    bool frontFace = true;
-                    if (y > 0 && getChunk(id).getBlock({x, y - 1, z}).getBlockId() == Block::BlockTypes::SOLID) {
-                        frontFace = false;
-                    }
-
-                    bool backFace = true;
-                    if (y < CHUNK_SIZE - 1 && getChunk(id).getBlock({x, y + 1, z}).getBlockId() == Block::BlockTypes::SOLID) {
-                        backFace = false;
-                    }
-
-                    VulkanEngineModel::Builder faces = Block::getCubeFaces({x, y, z}, {1.0f, 1.0f, 1.0f}, color, leftFace, rightFace, topFace, bottomFace, frontFace,
-                                                                           backFace);
-                    for (auto vertex: faces.vertices) {
-                        terrainBuilder.vertices.emplace_back(vertex);
-                    }
-                    for (auto index: faces.indices) {
-                        terrainBuilder.indices.emplace_back(index + i);
-                    }
-                    i += (long) faces.vertices.size();
-                }
-            }
+ChunkPrefab ChunkManager::generateChunkGameObjectPrefab(Chunk &chunk, const ChunkMesher::ChunkApron &apron, ChunkMesher::MeshingMode mode) {
+    const glm::uvec2 position = chunk.getChunkPosition();
+    CORE_TRACE("Chunk {}_{} begins meshing\n", position.x, position.y);
+
+    const content_hash blocksHash = chunk.getBlocksHash();
+
+    // The tint follows the content so identical chunks can share their model
+    float r = static_cast <float> (blocksHash & 0xFF) / 255.0f;
+    float g = static_cast <float> ((blocksHash >> 8) & 0xFF) / 255.0f;
+    float b = static_cast <float> ((blocksHash >> 16) & 0xFF) / 255.0f;
+    chunk.setColor({r, g, b});
+
+    return meshChunk(chunk, apron, mode);
+}
+
+ChunkPrefab ChunkManager::meshChunk(Chunk &chunk, const ChunkMesher::ChunkApron &apron, ChunkMesher::MeshingMode mode) {
+    ChunkPrefab prefab{};
+    prefab.contentHash = hashMeshInputs(chunk, apron, mode);
+    prefab.contentKey = getMeshInputs(chunk, apron, mode);
+    prefab.cachedModel = modelCache.find(prefab.contentHash, prefab.contentKey);
+
+    if (prefab.cachedModel == nullptr) {
+        if (modelCache.meshesOnGpu()) {
+            prefab.blockIds.resize(CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH);
+            chunk.getBlocks().copyTo(prefab.blockIds.data());
+            prefab.apronRows = ChunkMesher::getApronRows(apron);
+        } else if (CHUNK_VERTEX_PULLING) {
+            prefab.faceBuilder = ChunkMesher::generateFaces(chunk, apron);
+        } else if (CHUNK_VERTICES_PACKED) {
+            // Like the tint the palette entry follows the content, it is covered by the blocks hash
+            const auto colorIndex = static_cast<uint32_t>(chunk.getBlocksHash() & 0xFF);
+            prefab.terrainBuilder = ChunkMesher::generatePackedMesh(chunk, apron, colorIndex, mode);
+        } else {
+            prefab.builder = ChunkMesher::generateMesh(chunk, apron, chunk.getColor(), mode);
         }
     }
+    return prefab;
+}
 
-    return terrainBuilder;
+content_hash ChunkManager::hashMeshInputs(Chunk &chunk, const ChunkMesher::ChunkApron &apron, ChunkMesher::MeshingMode mode) {
+    // The color is derived from the blocks hash, so it does not need to be hashed again
+    content_hash hash = chunk.getBlocksHash();
+    for (const auto *rows: {&apron.left, &apron.right, &apron.front, &apron.back}) {
+        hash = hashBytes(rows->data(), rows->size() * sizeof(ChunkMesher::Kernels::Row), hash);
+    }
+    return hashBytes(&mode, sizeof(mode), hash);
 }
 
-void ChunkManager::populateChunk(Chunk &chunk, ChunkDeserializer::RawChunkData rawData) {
-    assert(rawData.size() == CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH && "Raw chunk data has incorrect size");
-    uint32_t x = 0;
-    uint32_t y = 0;
-    uint32_t z = 0;
+content_key ChunkManager::getMeshInputs(Chunk &chunk, const ChunkMesher::ChunkApron &apron, ChunkMesher::MeshingMode mode) {
+    content_key key{};
+    chunk.getBlocks().appendContent(key);
+    for (const auto *rows: {&apron.left, &apron.right, &apron.front, &apron.back}) {
+        const auto *bytes = reinterpret_cast<const unsigned char *>(rows->data());
+        key.insert(key.end(), bytes, bytes + rows->size() * sizeof(ChunkMesher::Kernels::Row));
+    }
+    const auto *modeBytes = reinterpret_cast<const unsigned char *>(&mode);
+    key.insert(key.end(), modeBytes, modeBytes + sizeof(mode));
+    return key;
+}
 
-    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH; i++) {
-        if (x == CHUNK_SIZE) {
-            x = 0;
-            y += 1;
-        }
-        if (y == CHUNK_SIZE) {
-            z += 1;
-            y = 0;
-        }
+Chunk *ChunkManager::findMeshedChunk(glm::ivec2 position) {
+    if (!isInsideMapRange(glm::vec2(position))) return nullptr;
+
+    auto it = _chunks.find(Chunk::getChunkId(glm::uvec2(position)));
+    if (it == _chunks.end() || it->second.getChunkState() != CHUNK_STATE_VISIBLE) return nullptr;
 
-        Block &b = chunk.getBlock({x, y, z});
-        unsigned char data = rawData[i];
-        b.setBlockId(data);
-        x += 1;
+    // Visible chunks are fully populated and their blocks are no longer written
+    return &it->second;
+}
+
+ChunkMesher::ChunkApron ChunkManager::buildChunkApron(glm::uvec2 position) {
+    const glm::ivec2 pos = position;
+    return ChunkMesher::buildApron(findMeshedChunk({pos.x - CHUNK_SIZE, pos.y}),
+                                   findMeshedChunk({pos.x + CHUNK_SIZE, pos.y}),
+                                   findMeshedChunk({pos.x, pos.y - CHUNK_SIZE}),
+                                   findMeshedChunk({pos.x, pos.y + CHUNK_SIZE}));
+}
+
+void ChunkManager::populateChunk(Chunk &chunk, const ChunkStore::ChunkPayload &payload) {
+    ChunkBlockStorage &blocks = chunk.getBlocks();
+
+    // Chunks sharing a payload with a recently loaded one reuse its blocks and hash
+    if (auto cached = decodedCache.find(payload)) {
+        blocks = cached->blocks;
+        chunk.setBlocksHash(cached->blocksHash);
+        return;
     }
+
+    // Runs are packed straight into the chunk storage, there is no intermediate per voxel buffer
+    const bool decoded = blocks.assignEncoded(payload.data(), payload.size());
+    if (!decoded) {
+        const glm::uvec2 position = chunk.getChunkPosition();
+        CORE_ERROR("Chunk {}_{} is missing or malformed, it is left empty\n", position.x, position.y);
+        blocks.fill(Block::BlockTypes::AIR);
+    }
+
+    const content_hash blocksHash = blocks.hash();
+    chunk.setBlocksHash(blocksHash);
+    if (decoded) {
+        decodedCache.insert(std::make_shared<const DecodedChunkCache::DecodedChunk>(DecodedChunkCache::DecodedChunk{payload, blocks, blocksHash}));
+    }
+}
+
+void ChunkManager::populateUniformChunk(Chunk &chunk, Block::block_id blockId) {
+    static_assert(ChunkSummary::SOLID_BLOCK_ID == Block::BlockTypes::SOLID, "Summaries count solid blocks with the engine's solid id");
+    ChunkBlockStorage &blocks = chunk.getBlocks();
+
+    blocks.fill(blockId);
+    chunk.setBlocksHash(blocks.hash());
 }
 
 ChunkManager::ChunkMap &ChunkManager::getVisibleChunks() {
@@ -0,0 +1,51 @@
+#include "../../include/rendering/ChunkMesher.h"
+
+template<uint32_t Size>
+static VulkanEngine::VulkanModel::Builder generateIsolatedMesh(const Block *blocks, glm::vec3 color, ChunkMesher::MeshingMode mode) {
+    using Kernels = ChunkMeshingKernels<Size, CHUNK_DEPTH>;
+    return Kernels::generateMesh(typename Kernels::BlockArray{blocks}, typename Kernels::Apron{}, color, mode == ChunkMesher::GREEDY);
+}
+
+template<uint32_t Size>
+static ChunkMesher::KernelTable makeKernelTable() {
+    return {Size, CHUNK_DEPTH, &ChunkMeshingKernels<Size, CHUNK_DEPTH>::decodeBlocks, &generateIsolatedMesh<Size>};
+}
+
+const ChunkMesher::KernelTable *ChunkMesher::findKernelTable(uint32_t chunkSize) {
+    static const KernelTable tables[] = {makeKernelTable<16>(), makeKernelTable<32>(), makeKernelTable<64>()};
+
+    for (const auto &table: tables) {
+        if (table.chunkSize == chunkSize) return &table;
+    }
+    return nullptr;
+}
+
+VulkanEngine::VulkanModel::Builder ChunkMesher::generateMesh(Chunk &chunk, const ChunkApron &apron, glm::vec3 color, MeshingMode mode) {
+    return Kernels::generateMesh(chunk.getBlocks(), apron, color, mode == GREEDY);
+}
+
+VulkanEngine::VulkanModel::TerrainBuilder ChunkMesher::generatePackedMesh(Chunk &chunk, const ChunkApron &apron, uint32_t colorIndex, MeshingMode mode) {
+    return Kernels::generatePackedMesh(chunk.getBlocks(), apron, colorIndex, mode == GREEDY);
+}
+
+VulkanEngine::VulkanModel::FaceBuilder ChunkMesher::generateFaces(Chunk &chunk, const ChunkApron &apron) {
+    return Kernels::generateFaces(chunk.getBlocks(), apron);
+}
+
+std::vector<uint32_t> ChunkMesher::getApronRows(const ChunkApron &apron) {
+    static_assert(std::is_same_v<Kernels::Row, uint32_t>, "The compute mesher reads the apron as 32-bit rows");
+
+    std::vector<uint32_t> rows{};
+    rows.reserve(4 * CHUNK_DEPTH);
+    for (const auto *side: {&apron.left, &apron.right, &apron.front, &apron.back}) {
+        rows.insert(rows.end(), side->begin(), side->end());
+    }
+    return rows;
+}
+
+ChunkMesher::ChunkApron ChunkMesher::buildApron(Chunk *left, Chunk *right, Chunk *front, Chunk *back) {
+    return Kernels::buildApron(left != nullptr ? &left->getBlocks() : nullptr,
+                               right != nullptr ? &right->getBlocks() : nullptr,
+                               front != nullptr ? &front->getBlocks() : nullptr,
+                               back != nullptr ? &back->getBlocks() : nullptr);
+}
@@ -0,0 +1,87 @@
+#include "../../include/rendering/ChunkModelCache.h"
+#include <platform/vulkan/VulkanComputeMesher.h>
+
+#include <algorithm>
+
+std::shared_ptr<VulkanEngine::VulkanModel> ChunkModelCache::find(content_hash hash, const content_key &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = models.find(hash);
+    if (it == models.end() || it->second.key != key) return nullptr;
+    return it->second.model.lock();
+}
+
+std::shared_ptr<VulkanEngine::VulkanModel> ChunkModelCache::getOrCreate(VulkanEngine::VulkanDevice &device, content_hash hash, content_key key,
+                                                                        const VulkanEngine::VulkanModel::Builder &builder) {
+    if (auto model = find(hash, key)) return model;
+
+    // Uploading happens outside of the lock, only this thread inserts models
+    return insert(hash, std::move(key), std::make_shared<VulkanEngine::VulkanModel>(device, builder, quadIndexBuffer));
+}
+
+std::shared_ptr<VulkanEngine::VulkanModel> ChunkModelCache::getOrCreate(VulkanEngine::VulkanDevice &device, content_hash hash, content_key key,
+                                                                        const VulkanEngine::VulkanModel::TerrainBuilder &builder) {
+    if (auto model = find(hash, key)) return model;
+    return insert(hash, std::move(key), std::make_shared<VulkanEngine::VulkanModel>(device, builder, quadIndexBuffer));
+}
+
+std::shared_ptr<VulkanEngine::VulkanModel> ChunkModelCache::getOrCreate(VulkanEngine::VulkanDevice &device, content_hash hash, content_key key,
+                                                                        const VulkanEngine::VulkanModel::FaceBuilder &builder) {
+    if (auto model = find(hash, key)) return model;
+    return insert(hash, std::move(key), std::make_shared<VulkanEngine::VulkanModel>(device, builder, faceSetLayout, descriptorPool));
+}
+
+std::vector<std::shared_ptr<VulkanEngine::VulkanModel>> ChunkModelCache::getOrCreate(std::vector<GpuMeshRequest> requests) {
+    assert(computeMesher != nullptr && "GPU meshing inputs were gathered without a compute mesher");
+    std::vector<std::shared_ptr<VulkanEngine::VulkanModel>> models(requests.size());
+
+    // Requests with the same content in one batch are meshed once, the later ones point at the first
+    std::vector<VulkanEngine::VulkanComputeMesher::ChunkInputs> inputs{};
+    std::vector<size_t> meshed{};
+    std::vector<size_t> sameAs(requests.size(), requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+        if ((models[i] = find(requests[i].hash, requests[i].key))) continue;
+
+        auto first = std::find_if(meshed.begin(), meshed.end(), [&](size_t j) {
+            return requests[j].hash == requests[i].hash && requests[j].key == requests[i].key;
+        });
+        if (first != meshed.end()) {
+            sameAs[i] = *first;
+            continue;
+        }
+        meshed.push_back(i);
+        inputs.push_back({requests[i].blockIds, requests[i].apronRows});
+    }
+
+    std::vector<std::unique_ptr<VulkanEngine::VulkanModel>> meshedModels = computeMesher->MeshChunks(inputs);
+    for (size_t k = 0; k < meshed.size(); k++) {
+        // Chunks without faces get no model and are not cached
+        if (meshedModels[k] == nullptr) continue;
+        GpuMeshRequest &request = requests[meshed[k]];
+        models[meshed[k]] = insert(request.hash, std::move(request.key), std::move(meshedModels[k]));
+    }
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (sameAs[i] != requests.size()) models[i] = models[sameAs[i]];
+    }
+
+    return models;
+}
+
+std::shared_ptr<VulkanEngine::VulkanModel> ChunkModelCache::insert(content_hash hash, content_key key, std::shared_ptr<VulkanEngine::VulkanModel> model) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Expired entries are dropped once the map doubled since the last sweep, which keeps inserts amortized constant
+    if (models.size() >= pruneThreshold) {
+        for (auto it = models.begin(); it != models.end();) {
+            it = it->second.model.expired() ? models.erase(it) : std::next(it);
+        }
+        pruneThreshold = std::max(MIN_PRUNE_THRESHOLD, models.size() * 2);
+    }
+    // A colliding entry is replaced, chunks already using its model keep it
+    models[hash] = {std::move(key), model};
+    return model;
+}
+
+size_t ChunkModelCache::getLiveModelCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::count_if(models.begin(), models.end(), [](const auto &entry) { return !entry.second.model.expired(); });
+}
@@ -0,0 +1,211 @@
+#include "../../include/rendering/ChunkRegionStore.h"
+#include "../../include/rendering/ContentHash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char REGION_MAGIC[4] = {'M', 'R', 'G', 'N'};
+
+ChunkRegionStore::ChunkRegionStore(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open region file: " + path);
+    }
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t) sizeof(RegionHeader)) {
+        close(fd);
+        throw std::runtime_error("Region file is too small: " + path);
+    }
+    mappingSize = static_cast<size_t>(fileStat.st_size);
+
+    // The mapping stays valid after the descriptor is closed
+    void *address = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Failed to map region file: " + path);
+    }
+    mapping = static_cast<const unsigned char *>(address);
+
+    // Chunks are loaded in small random reads around the player
+    madvise(address, mappingSize, MADV_RANDOM);
+
+    header = reinterpret_cast<const RegionHeader *>(mapping);
+    entries = reinterpret_cast<const RegionEntry *>(mapping + sizeof(RegionHeader));
+
+    if (!isCompatible(*header) || getIndexEnd(*header) > mappingSize) {
+        munmap(address, mappingSize);
+        throw std::runtime_error("Invalid region file or one written for different chunk dimensions: " + path);
+    }
+}
+
+bool ChunkRegionStore::isCompatible(const RegionHeader &regionHeader) {
+    return std::memcmp(regionHeader.magic, REGION_MAGIC, sizeof(REGION_MAGIC)) == 0 && regionHeader.version == VERSION &&
+           regionHeader.chunkSize == CHUNK_SIZE && regionHeader.chunkDepth == CHUNK_DEPTH;
+}
+
+size_t ChunkRegionStore::getIndexEnd(const RegionHeader &regionHeader) {
+    return sizeof(RegionHeader) + sizeof(RegionEntry) * regionHeader.gridWidth * regionHeader.gridHeight;
+}
+
+uint32_t ChunkRegionStore::getEntryIndex(const RegionHeader &regionHeader, glm::uvec2 chunk_pos) {
+    const uint32_t gridX = chunk_pos.x / CHUNK_SIZE;
+    const uint32_t gridY = chunk_pos.y / CHUNK_SIZE;
+    if (gridX >= regionHeader.gridWidth || gridY >= regionHeader.gridHeight) return NO_ENTRY;
+
+    return gridX * regionHeader.gridHeight + gridY;
+}
+
+uint32_t ChunkRegionStore::loadEntrySummaries(const RegionHeader &regionHeader, const RegionEntry *regionEntries, ChunkSummaryIndex &index) {
+    uint32_t loaded = 0;
+    for (uint32_t gridX = 0; gridX < regionHeader.gridWidth; gridX++) {
+        for (uint32_t gridY = 0; gridY < regionHeader.gridHeight; gridY++) {
+            const RegionEntry &entry = regionEntries[gridX * regionHeader.gridHeight + gridY];
+            if (entry.length == 0) continue;
+
+            ChunkSummary summary{};
+            summary.minSolidHeight = entry.minSolidHeight;
+            summary.maxSolidHeight = entry.maxSolidHeight;
+            summary.solidCount = entry.solidCount;
+            summary.uniformBlockId = entry.uniformBlockId;
+            index.set({gridX * CHUNK_SIZE, gridY * CHUNK_SIZE}, summary);
+            loaded++;
+        }
+    }
+    return loaded;
+}
+
+uint64_t ChunkRegionStore::getSourceFingerprint(const std::string &sourcePath) {
+    struct stat fileStat{};
+    if (stat(sourcePath.c_str(), &fileStat) != 0) return 0;
+
+    // Size and modification time, hashing the whole database would cost as much as writing the archive
+    const int64_t identity[3] = {static_cast<int64_t>(fileStat.st_size), static_cast<int64_t>(fileStat.st_mtim.tv_sec),
+                                 static_cast<int64_t>(fileStat.st_mtim.tv_nsec)};
+    return hashBytes(identity, sizeof(identity));
+}
+
+bool ChunkRegionStore::isUpToDate(const std::string &path, uint64_t sourceFingerprint) {
+    std::ifstream file{path, std::ios::binary};
+    RegionHeader regionHeader{};
+    if (!file.read(reinterpret_cast<char *>(&regionHeader), sizeof(regionHeader))) return false;
+
+    return isCompatible(regionHeader) && regionHeader.sourceFingerprint == sourceFingerprint;
+}
+
+bool ChunkRegionStore::loadSummaries(ChunkSummaryIndex &index) {
+    CORE_INFO("Loaded {} chunk summaries\n", loadEntrySummaries(*header, entries, index));
+    return true;
+}
+
+ChunkRegionStore::~ChunkRegionStore() {
+    munmap(const_cast<unsigned char *>(mapping), mappingSize);
+}
+
+bool ChunkRegionStore::getChunkPayload(glm::uvec2 chunk_pos, const unsigned char *&data, size_t &size) const {
+    const uint32_t entryIndex = getEntryIndex(*header, chunk_pos);
+    if (entryIndex == NO_ENTRY) return false;
+
+    const RegionEntry &entry = entries[entryIndex];
+    // Written so a corrupt offset cannot wrap around
+    if (entry.length == 0 || entry.offset > mappingSize || entry.length > mappingSize - entry.offset) return false;
+
+    data = mapping + entry.offset;
+    size = entry.length;
+    return true;
+}
+
+ChunkStore::RawChunkData ChunkRegionStore::deserializeChunk(glm::uvec2 chunk_pos) {
+    const unsigned char *payload;
+    size_t payloadSize;
+    if (!getChunkPayload(chunk_pos, payload, payloadSize)) return {};
+
+    // The only copy is the decode out of the page cache
+    RawChunkData chunkData(CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH);
+    if (!ChunkEncoding::decode(payload, payloadSize, chunkData.data(), chunkData.size())) {
+        CORE_ERROR("Chunk {}_{} has a malformed region payload\n", chunk_pos.x, chunk_pos.y);
+        return {};
+    }
+    return chunkData;
+}
+
+ChunkStore::ChunkPayload ChunkRegionStore::readChunkPayload(glm::uvec2 chunk_pos) {
+    const unsigned char *payload;
+    size_t payloadSize;
+    if (!getChunkPayload(chunk_pos, payload, payloadSize)) return {};
+
+    return {payload, payload + payloadSize};
+}
+
+void ChunkRegionStore::writeRegionFile(const std::string &path, ChunkStore &source, uint64_t sourceFingerprint) {
+    RegionHeader regionHeader{};
+    std::memcpy(regionHeader.magic, REGION_MAGIC, sizeof(REGION_MAGIC));
+    regionHeader.version = VERSION;
+    regionHeader.chunkSize = CHUNK_SIZE;
+    regionHeader.chunkDepth = CHUNK_DEPTH;
+    regionHeader.gridWidth = MAP_WIDTH / CHUNK_SIZE;
+    regionHeader.gridHeight = MAP_HEIGHT / CHUNK_SIZE;
+    regionHeader.sourceFingerprint = sourceFingerprint;
+
+    std::vector<RegionEntry> index(regionHeader.gridWidth * regionHeader.gridHeight, RegionEntry{});
+    std::vector<unsigned char> payloads{};
+    // Stored payloads by hash, a hit is compared against the stored bytes. Entries are relative to the payload start.
+    std::unordered_multimap<content_hash, RegionEntry> storedPayloads{};
+    const uint64_t payloadStart = getIndexEnd(regionHeader);
+
+    for (uint32_t x = 0; x < regionHeader.gridWidth; x++) {
+        for (uint32_t y = 0; y < regionHeader.gridHeight; y++) {
+            RawChunkData chunkData = source.deserializeChunk({x * CHUNK_SIZE, y * CHUNK_SIZE});
+            if (chunkData.size() != CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH) continue;
+
+            std::vector<unsigned char> encoded = ChunkEncoding::encode(chunkData.data(), chunkData.size());
+            RegionEntry &entry = index[x * regionHeader.gridHeight + y];
+            entry.length = static_cast<uint32_t>(encoded.size());
+
+            const ChunkSummary summary = ChunkSummary::compute(chunkData.data());
+            entry.solidCount = summary.solidCount;
+            entry.minSolidHeight = summary.minSolidHeight;
+            entry.maxSolidHeight = summary.maxSolidHeight;
+            entry.uniformBlockId = summary.uniformBlockId;
+
+            // Identical payloads are stored once and shared by every entry pointing at them
+            const content_hash hash = hashBytes(encoded.data(), encoded.size());
+            auto [stored, end] = storedPayloads.equal_range(hash);
+            while (stored != end && (stored->second.length != entry.length ||
+                                     std::memcmp(payloads.data() + stored->second.offset, encoded.data(), encoded.size()) != 0)) {
+                ++stored;
+            }
+            if (stored != end) {
+                entry.offset = payloadStart + stored->second.offset;
+                continue;
+            }
+            storedPayloads.emplace(hash, RegionEntry{payloads.size(), entry.length});
+            entry.offset = payloadStart + payloads.size();
+            payloads.insert(payloads.end(), encoded.begin(), encoded.end());
+        }
+    }
+
+    const std::string temporaryPath = path + ".tmp";
+    std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to create region file: " + temporaryPath);
+    }
+    file.write(reinterpret_cast<const char *>(&regionHeader), sizeof(regionHeader));
+    file.write(reinterpret_cast<const char *>(index.data()), static_cast<std::streamsize>(sizeof(RegionEntry) * index.size()));
+    file.write(reinterpret_cast<const char *>(payloads.data()), static_cast<std::streamsize>(payloads.size()));
+    file.close();
+
+    if (file.fail() || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        throw std::runtime_error("Failed to write region file: " + path);
+    }
+}
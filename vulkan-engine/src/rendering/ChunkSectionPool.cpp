@@ -0,0 +1,58 @@
+#include "../../include/rendering/ChunkSectionPool.h"
+
+void ChunkSectionPool::Handle::reset() {
+    if (words == nullptr) return;
+    getInstance().release(words, wordCount);
+    words = nullptr;
+    wordCount = 0;
+}
+
+ChunkSectionPool &ChunkSectionPool::getInstance() {
+    // Never destroyed, storages owned by other static objects may still release their buffers during exit
+    static auto *pool = new ChunkSectionPool();
+    return *pool;
+}
+
+ChunkSectionPool::Handle ChunkSectionPool::acquire(uint32_t wordCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Word *> &free = freeBuffers[wordCount];
+
+    if (free.empty()) {
+        const size_t slabWords = size_t{wordCount} * SLAB_BUFFERS;
+        slabs.emplace_back(std::make_unique<Word[]>(slabWords), slabWords * sizeof(Word));
+
+        Word *slab = slabs.back().first.get();
+        free.reserve(free.size() + SLAB_BUFFERS);
+        // Handed out from the front of the slab first
+        for (uint32_t i = SLAB_BUFFERS; i > 0; i--) {
+            free.push_back(slab + size_t{i - 1} * wordCount);
+        }
+    }
+
+    Word *words = free.back();
+    free.pop_back();
+    return {words, wordCount};
+}
+
+size_t ChunkSectionPool::getSlabBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t bytes = 0;
+    for (const auto &slab: slabs) {
+        bytes += slab.second;
+    }
+    return bytes;
+}
+
+size_t ChunkSectionPool::getFreeBufferCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto &free: freeBuffers) {
+        count += free.second.size();
+    }
+    return count;
+}
+
+void ChunkSectionPool::release(Word *words, uint32_t wordCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers[wordCount].push_back(words);
+}
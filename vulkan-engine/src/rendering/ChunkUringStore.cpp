@@ -0,0 +1,137 @@
+#include "../../include/rendering/ChunkUringStore.h"
+
+#if CHUNK_STORE_URING
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+ChunkUringStore::ChunkUringStore(const std::string &path) {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open region file: " + path);
+    }
+
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header) || !ChunkRegionStore::isCompatible(header)) {
+        close(fd);
+        throw std::runtime_error("Invalid region file or one written for different chunk dimensions: " + path);
+    }
+
+    entries.resize(header.gridWidth * header.gridHeight);
+    const auto indexSize = static_cast<ssize_t>(sizeof(ChunkRegionStore::RegionEntry) * entries.size());
+    if (pread(fd, entries.data(), indexSize, sizeof(header)) != indexSize) {
+        close(fd);
+        throw std::runtime_error("Region file index is truncated: " + path);
+    }
+
+    const int result = io_uring_queue_init(QUEUE_DEPTH, &ring, 0);
+    if (result < 0) {
+        close(fd);
+        throw std::runtime_error("Failed to set up io_uring for region file: " + path);
+    }
+}
+
+ChunkUringStore::~ChunkUringStore() {
+    io_uring_queue_exit(&ring);
+    close(fd);
+}
+
+bool ChunkUringStore::loadSummaries(ChunkSummaryIndex &index) {
+    CORE_INFO("Loaded {} chunk summaries\n", ChunkRegionStore::loadEntrySummaries(header, entries.data(), index));
+    return true;
+}
+
+const ChunkRegionStore::RegionEntry *ChunkUringStore::findEntry(glm::uvec2 chunk_pos) const {
+    const uint32_t entryIndex = ChunkRegionStore::getEntryIndex(header, chunk_pos);
+    if (entryIndex == ChunkRegionStore::NO_ENTRY || entries[entryIndex].length == 0) return nullptr;
+
+    return &entries[entryIndex];
+}
+
+ChunkStore::RawChunkData ChunkUringStore::deserializeChunk(glm::uvec2 chunk_pos) {
+    ChunkPayload payload = readChunkPayload(chunk_pos);
+
+    RawChunkData chunkData(CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH);
+    if (payload.empty() || !ChunkEncoding::decode(payload.data(), payload.size(), chunkData.data(), chunkData.size())) return {};
+    return chunkData;
+}
+
+ChunkStore::ChunkPayload ChunkUringStore::readChunkPayload(glm::uvec2 chunk_pos) {
+    const ChunkRegionStore::RegionEntry *entry = findEntry(chunk_pos);
+    if (entry == nullptr) return {};
+
+    ChunkPayload payload(entry->length);
+    if (pread(fd, payload.data(), entry->length, static_cast<off_t>(entry->offset)) != static_cast<ssize_t>(entry->length)) return {};
+    return payload;
+}
+
+std::vector<ChunkStore::ChunkPayload> ChunkUringStore::readChunkPayloads(const std::vector<glm::uvec2> &positions) {
+    std::vector<ChunkPayload> payloads(positions.size());
+    std::lock_guard<std::mutex> lock(ringMutex);
+
+    size_t next = 0;
+    unsigned inFlight = 0;
+    while (next < positions.size() || inFlight > 0) {
+        // Fill the submission queue, the payload buffers are sized up front so the kernel reads straight into them
+        while (next < positions.size() && inFlight < QUEUE_DEPTH) {
+            const ChunkRegionStore::RegionEntry *entry = findEntry(positions[next]);
+            if (entry == nullptr) {
+                next++;
+                continue;
+            }
+
+            // A full submission queue is flushed once, without a free entry the read waits for completions or, with nothing
+            // in flight to wait for, is done right away
+            io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+            if (sqe == nullptr && io_uring_submit(&ring) >= 0) sqe = io_uring_get_sqe(&ring);
+            if (sqe == nullptr) {
+                if (inFlight > 0) break;
+                payloads[next] = readChunkPayload(positions[next]);
+                next++;
+                continue;
+            }
+
+            payloads[next].resize(entry->length);
+            io_uring_prep_read(sqe, fd, payloads[next].data(), entry->length, entry->offset);
+            io_uring_sqe_set_data(sqe, reinterpret_cast<void *>(static_cast<uintptr_t>(next)));
+            next++;
+            inFlight++;
+        }
+        if (inFlight == 0) continue;
+
+        const int submitted = io_uring_submit_and_wait(&ring, 1);
+        if (submitted < 0) {
+            CORE_ERROR("io_uring submission failed with {}, falling back to blocking reads\n", submitted);
+            // Drain what is still in flight before its buffers are replaced
+            io_uring_cqe *cqe;
+            while (inFlight > 0 && io_uring_wait_cqe(&ring, &cqe) == 0) {
+                io_uring_cqe_seen(&ring, cqe);
+                inFlight--;
+            }
+            for (size_t i = 0; i < positions.size(); i++) {
+                payloads[i] = readChunkPayload(positions[i]);
+            }
+            return payloads;
+        }
+
+        // Completions arrive in any order, the user data carries the position index
+        io_uring_cqe *cqe;
+        unsigned head;
+        unsigned reaped = 0;
+        io_uring_for_each_cqe(&ring, head, cqe) {
+            const auto index = static_cast<size_t>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe)));
+            if (cqe->res != static_cast<int>(payloads[index].size())) {
+                CORE_ERROR("Chunk {}_{} read returned {}\n", positions[index].x, positions[index].y, cqe->res);
+                payloads[index].clear();
+            }
+            reaped++;
+        }
+        io_uring_cq_advance(&ring, reaped);
+        inFlight -= reaped;
+    }
+
+    return payloads;
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include "../../include/rendering/DecodedChunkCache.h"
+
+std::shared_ptr<const DecodedChunkCache::DecodedChunk> DecodedChunkCache::find(const ChunkStore::ChunkPayload &payload) {
+    const content_hash hash = hashBytes(payload.data(), payload.size());
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(hash);
+    if (it == index.end() || it->second->second->payload != payload) {
+        misses++;
+        return nullptr;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+    return it->second->second;
+}
+
+void DecodedChunkCache::insert(std::shared_ptr<const DecodedChunk> decoded) {
+    const content_hash hash = hashBytes(decoded->payload.data(), decoded->payload.size());
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(hash);
+    if (it != index.end()) {
+        // Another worker decoded the same payload first, or a colliding payload is replaced
+        it->second->second = std::move(decoded);
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    entries.emplace_front(hash, std::move(decoded));
+    index[hash] = entries.begin();
+    if (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
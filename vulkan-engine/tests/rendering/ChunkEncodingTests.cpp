@@ -0,0 +1,149 @@
+// Round trips of the binary chunk payload and the payloads the decoder has to reject
+#include "../../include/GlobalConfiguration.h"
+#include "../../include/rendering/ChunkEncoding.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                \
+    do {                                                                                \
+        if (!(condition)) {                                                             \
+            std::fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                                 \
+        }                                                                               \
+    } while (false)
+
+static constexpr size_t BLOCK_COUNT = CHUNK_SIZE * CHUNK_SIZE * CHUNK_DEPTH;
+
+static std::vector<unsigned char> header() {
+    return {'C', 'H', 'K', ChunkEncoding::VERSION};
+}
+
+static void appendRun(std::vector<unsigned char> &data, uint64_t length, unsigned char id) {
+    while (length >= 0x80) {
+        data.push_back(static_cast<unsigned char>(length | 0x80));
+        length >>= 7;
+    }
+    data.push_back(static_cast<unsigned char>(length));
+    data.push_back(id);
+}
+
+static bool decodes(const std::vector<unsigned char> &data) {
+    std::vector<unsigned char> blocks(BLOCK_COUNT);
+    return ChunkEncoding::decode(data.data(), data.size(), blocks.data(), blocks.size());
+}
+
+static void roundTrip(const std::vector<unsigned char> &blocks) {
+    const std::vector<unsigned char> data = ChunkEncoding::encode(blocks.data(), blocks.size());
+    CHECK(ChunkEncoding::isEncoded(data.data(), data.size()));
+
+    std::vector<unsigned char> decoded(blocks.size(), 0);
+    CHECK(ChunkEncoding::decode(data.data(), data.size(), decoded.data(), decoded.size()));
+    CHECK(decoded == blocks);
+
+    decoded.assign(blocks.size(), 0);
+    CHECK(ChunkEncoding::decodeAnyFormat(data.data(), data.size(), decoded.data(), decoded.size()));
+    CHECK(decoded == blocks);
+}
+
+static void testRoundTrips() {
+    // One run whose length needs three varint bytes
+    roundTrip(std::vector<unsigned char>(BLOCK_COUNT, 'a'));
+
+    // Single block runs at both ends and runs on either side of the one and two byte varint limits
+    std::vector<unsigned char> blocks(BLOCK_COUNT, 'a');
+    blocks.front() = 's';
+    blocks.back() = 's';
+    std::fill(blocks.begin() + 1000, blocks.begin() + 1000 + 127, 's');
+    std::fill(blocks.begin() + 2000, blocks.begin() + 2000 + 128, 's');
+    std::fill(blocks.begin() + 20000, blocks.begin() + 20000 + 16383, 's');
+    std::fill(blocks.begin() + 40000, blocks.begin() + 40000 + 16384, 's');
+    roundTrip(blocks);
+
+    // Every block its own run
+    for (size_t i = 0; i < blocks.size(); i++) {
+        blocks[i] = (i & 1) ? 's' : 'a';
+    }
+    roundTrip(blocks);
+}
+
+static void testTextRows() {
+    const std::string text = "1024s" + std::to_string(BLOCK_COUNT - 1024) + "a";
+    std::vector<unsigned char> blocks(BLOCK_COUNT);
+    CHECK(ChunkEncoding::decodeAnyFormat(reinterpret_cast<const unsigned char *>(text.data()), text.size(), blocks.data(), blocks.size()));
+    CHECK(blocks[0] == 's' && blocks[1023] == 's' && blocks[1024] == 'a' && blocks.back() == 'a');
+
+    const std::string missingId = std::to_string(BLOCK_COUNT);
+    CHECK(!ChunkEncoding::decodeText(missingId.data(), missingId.size(), blocks.data(), blocks.size()));
+    const std::string missingLength = "s";
+    CHECK(!ChunkEncoding::decodeText(missingLength.data(), missingLength.size(), blocks.data(), blocks.size()));
+}
+
+static void testMalformedPayloads() {
+    std::vector<unsigned char> valid = header();
+    appendRun(valid, BLOCK_COUNT, 'a');
+    CHECK(decodes(valid));
+
+    // Every truncation of a valid payload, inside the header, the varint or before the block id
+    for (size_t size = 0; size < valid.size(); size++) {
+        CHECK(!decodes(std::vector<unsigned char>(valid.begin(), valid.begin() + static_cast<std::ptrdiff_t>(size))));
+    }
+
+    std::vector<unsigned char> wrongVersion = valid;
+    wrongVersion[3] = ChunkEncoding::VERSION + 1;
+    CHECK(!decodes(wrongVersion));
+
+    std::vector<unsigned char> wrongMagic = valid;
+    wrongMagic[0] = 'X';
+    CHECK(!decodes(wrongMagic));
+
+    // Runs short of or past the chunk
+    std::vector<unsigned char> shortRuns = header();
+    appendRun(shortRuns, BLOCK_COUNT - 1, 'a');
+    CHECK(!decodes(shortRuns));
+
+    std::vector<unsigned char> longRuns = header();
+    appendRun(longRuns, BLOCK_COUNT - 1, 'a');
+    appendRun(longRuns, 2, 's');
+    CHECK(!decodes(longRuns));
+
+    // A varint that keeps its continuation bit to the end of the payload
+    std::vector<unsigned char> unterminated = header();
+    unterminated.insert(unterminated.end(), 8, 0x80);
+    CHECK(!decodes(unterminated));
+
+    // More continuation bytes than a 64-bit length holds, the decoder stops at the tenth byte
+    std::vector<unsigned char> overlong = header();
+    overlong.insert(overlong.end(), 12, 0xFF);
+    overlong.push_back(0x01);
+    overlong.push_back('a');
+    CHECK(!decodes(overlong));
+
+    // A length far beyond the chunk must not wrap the written count
+    std::vector<unsigned char> huge = header();
+    appendRun(huge, UINT64_MAX, 'a');
+    CHECK(!decodes(huge));
+
+    // Trailing bytes after the runs that cover the chunk
+    std::vector<unsigned char> trailing = valid;
+    trailing.push_back(0x01);
+    CHECK(!decodes(trailing));
+}
+
+int main() {
+    testRoundTrips();
+    testTextRows();
+    testMalformedPayloads();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+// Exposed faces of the occupancy mask kernels against a per voxel reference that reads the blocks and the neighbor chunks
+#include <rendering/ChunkMeshingKernels.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                \
+    do {                                                                                \
+        if (!(condition)) {                                                             \
+            std::fprintf(stderr, "%s:%d: %s failed\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                                 \
+        }                                                                               \
+    } while (false)
+
+// Deterministic blocks with solid and air runs, uniform solid and air layers and isolated voxels
+template<typename Kernels>
+static std::vector<Block> generateBlocks(uint32_t seed) {
+    std::vector<Block> blocks(Kernels::VOLUME);
+    uint32_t state = seed * 2654435761u + 1;
+    for (uint32_t z = 0; z < Kernels::DEPTH; z++) {
+        for (uint32_t y = 0; y < Kernels::SIZE; y++) {
+            for (uint32_t x = 0; x < Kernels::SIZE; x++) {
+                state = state * 1664525u + 1013904223u;
+                bool solid = (state >> 24) % 3 != 0;
+                if (z % 8 == 3) solid = true;
+                if (z % 8 == 5) solid = false;
+                blocks[Kernels::serial(x, y, z)].setBlockId(solid ? Block::BlockTypes::SOLID : Block::BlockTypes::AIR);
+            }
+        }
+    }
+    return blocks;
+}
+
+template<typename Kernels>
+static bool isSolidAt(const std::vector<Block> *blocks, uint32_t x, uint32_t y, uint32_t z) {
+    // A missing neighbor is air
+    return blocks != nullptr && (*blocks)[Kernels::serial(x, y, z)].getBlockId() == Block::BlockTypes::SOLID;
+}
+
+// Neighbors are ordered left, right, front, back like buildApron
+template<typename Kernels>
+static bool isExposed(const std::vector<Block> &blocks, const std::array<const std::vector<Block> *, 4> &neighbors, uint32_t x, uint32_t y,
+                      uint32_t z, Block::FaceOrientation orientation) {
+    constexpr uint32_t last = Kernels::SIZE - 1;
+    if (!isSolidAt<Kernels>(&blocks, x, y, z)) return false;
+
+    switch (orientation) {
+        case Block::LEFT:
+            return x > 0 ? !isSolidAt<Kernels>(&blocks, x - 1, y, z) : !isSolidAt<Kernels>(neighbors[0], last, y, z);
+        case Block::RIGHT:
+            return x < last ? !isSolidAt<Kernels>(&blocks, x + 1, y, z) : !isSolidAt<Kernels>(neighbors[1], 0, y, z);
+        case Block::FRONT:
+            return y > 0 ? !isSolidAt<Kernels>(&blocks, x, y - 1, z) : !isSolidAt<Kernels>(neighbors[2], x, last, z);
+        case Block::BACK:
+            return y < last ? !isSolidAt<Kernels>(&blocks, x, y + 1, z) : !isSolidAt<Kernels>(neighbors[3], x, 0, z);
+        case Block::BOTTOM:
+            return z == 0 || !isSolidAt<Kernels>(&blocks, x, y, z - 1);
+        case Block::TOP:
+            return z == Kernels::DEPTH - 1 || !isSolidAt<Kernels>(&blocks, x, y, z + 1);
+    }
+    return false;
+}
+
+template<typename Kernels>
+static void checkExposedFaces(const std::vector<Block> &blocks, const std::array<const std::vector<Block> *, 4> &neighbors) {
+    using Array = typename Kernels::BlockArray;
+    using Row = typename Kernels::Row;
+    constexpr Block::FaceOrientation orientations[6] = {Block::LEFT, Block::RIGHT, Block::TOP, Block::BOTTOM, Block::FRONT, Block::BACK};
+
+    std::array<Array, 4> arrays{};
+    std::array<const Array *, 4> sources{};
+    for (size_t i = 0; i < neighbors.size(); i++) {
+        if (neighbors[i] == nullptr) continue;
+        arrays[i] = Array{neighbors[i]->data()};
+        sources[i] = &arrays[i];
+    }
+
+    const auto apron = Kernels::buildApron(sources[0], sources[1], sources[2], sources[3]);
+    const auto masks = Kernels::buildOccupancyMasks(Array{blocks.data()}, apron);
+
+    uint32_t expectedCount = 0;
+    uint32_t mismatches = 0;
+    for (auto orientation: orientations) {
+        for (uint32_t z = 0; z < Kernels::DEPTH; z++) {
+            for (uint32_t y = 0; y < Kernels::SIZE; y++) {
+                Row expected = 0;
+                for (uint32_t x = 0; x < Kernels::SIZE; x++) {
+                    expected |= Row{isExposed<Kernels>(blocks, neighbors, x, y, z, orientation)} << x;
+                }
+                expectedCount += __builtin_popcountll(expected);
+                if (Kernels::getExposedFaces(masks, y, z, orientation) != expected) mismatches++;
+            }
+        }
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(Kernels::countExposedFaces(masks) == expectedCount);
+}
+
+template<uint32_t Size, uint32_t Depth>
+static void testKernels() {
+    using Kernels = ChunkMeshingKernels<Size, Depth>;
+
+    const std::vector<Block> blocks = generateBlocks<Kernels>(1);
+    const std::vector<Block> left = generateBlocks<Kernels>(2);
+    const std::vector<Block> right = generateBlocks<Kernels>(3);
+    const std::vector<Block> front = generateBlocks<Kernels>(4);
+    const std::vector<Block> back = generateBlocks<Kernels>(5);
+    const std::vector<Block> air(Kernels::VOLUME, Block{});
+    std::vector<Block> solid(Kernels::VOLUME);
+    for (auto &block: solid) block.setBlockId(Block::BlockTypes::SOLID);
+
+    // Every neighbor loaded, none loaded and two adjacent ones loaded
+    checkExposedFaces<Kernels>(blocks, {&left, &right, &front, &back});
+    checkExposedFaces<Kernels>(blocks, {nullptr, nullptr, nullptr, nullptr});
+    checkExposedFaces<Kernels>(blocks, {&left, nullptr, &front, nullptr});
+    checkExposedFaces<Kernels>(blocks, {nullptr, &right, nullptr, &back});
+
+    // An all air chunk has no faces whatever its neighbors are, a solid one only those at the borders
+    checkExposedFaces<Kernels>(air, {&left, &right, &front, &back});
+    checkExposedFaces<Kernels>(solid, {&left, nullptr, &front, nullptr});
+    checkExposedFaces<Kernels>(solid, {&solid, &solid, &solid, &solid});
+}
+
+int main() {
+    testKernels<16, 16>();
+    testKernels<32, 24>();
+    testKernels<CHUNK_SIZE, CHUNK_DEPTH>();
+    testKernels<64, 16>();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}